@@ -5,6 +5,8 @@
  *
  *  main entry point for PSS multi-site scheduler
  */
+#include <cstdlib>
+#include <cstring>
 #include "pss_multisite_scheduler.hpp"
 
 using namespace std;
@@ -13,10 +15,12 @@ using namespace pss;
 int PssMultiSiteSchedule(const char *ms_shop_filename,
                          const char *ms_job_filename,
                          const char *ms_sched_filename,
-                         const char *ms_jls_filename) {
+                         const char *ms_jls_filename,
+                         unsigned num_threads) {
   try {
     MultisiteScheduler scheduler(ms_shop_filename, ms_job_filename,
-                                 ms_sched_filename, ms_jls_filename);
+                                 ms_sched_filename, ms_jls_filename,
+                                 num_threads);
     scheduler.Run();
     scheduler.PrintInfo(std::cout);
   } catch(RuntimeException &e) {
@@ -29,9 +33,16 @@ int PssMultiSiteSchedule(const char *ms_shop_filename,
 int PssMultiSiteMain(int argc, char **argv) {
   char const *ms_shop_filename, *ms_job_filename;
   char const *ms_sched_filename, *ms_jls_filename;
+  int num_threads = 1;
 
-  if(argc < 4 || argc > 5) {
-    std::cerr << "Usage: <multi-site shop file> <multi-site job file> "
+  if(argc > 2 && strcmp(argv[1], "-t") == 0) {
+    num_threads = atoi(argv[2]);
+    argc -= 2;
+    argv += 2;
+  }
+  if(argc < 4 || argc > 5 || num_threads < 1) {
+    std::cerr << "Usage: [-t <number of threads>] "
+              "<multi-site shop file> <multi-site job file> "
               "<multi-site output schedule file> [<multi-site output job file>]"
               << std::endl;
     return 0;
@@ -41,7 +52,8 @@ int PssMultiSiteMain(int argc, char **argv) {
   ms_sched_filename = argv[3];
   ms_jls_filename = (argc == 5) ? argv[4] : NULL;
   return PssMultiSiteSchedule(ms_shop_filename, ms_job_filename,
-                              ms_sched_filename, ms_jls_filename);
+                              ms_sched_filename, ms_jls_filename,
+                              (unsigned)num_threads);
 }
 
 int main(int argc, char **argv) {
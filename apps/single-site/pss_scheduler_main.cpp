@@ -5,6 +5,8 @@
  *
  *  main entry point for PSS single-site scheduler
  */
+#include <cstdlib>
+#include <cstring>
 #include "pss_scheduler.hpp"
 
 using namespace std;
@@ -13,10 +15,11 @@ using namespace pss;
 int PssSingleSiteSchedule(const char *shop_filename,
                           const char *job_filename,
                           const char *sched_filename,
-                          const char *jls_filename) {
+                          const char *jls_filename,
+                          unsigned num_threads) {
   try {
     Scheduler scheduler(shop_filename, job_filename,
-                        sched_filename, jls_filename);
+                        sched_filename, jls_filename, num_threads);
     scheduler.Run();
     scheduler.PrintInfo(std::cout);
   } catch(RuntimeException &e) {
@@ -28,9 +31,16 @@ int PssSingleSiteSchedule(const char *shop_filename,
 
 int PssSingleSiteMain(int argc, char **argv) {
   char const *shop_filename, *job_filename, *sched_filename, *jls_filename;
+  int num_threads = 1;
 
-  if(argc < 4 || argc > 5) {
-    std::cerr << "Usage: <shop file> <job file> <output schedule file> "
+  if(argc > 2 && strcmp(argv[1], "-t") == 0) {
+    num_threads = atoi(argv[2]);
+    argc -= 2;
+    argv += 2;
+  }
+  if(argc < 4 || argc > 5 || num_threads < 1) {
+    std::cerr << "Usage: [-t <number of threads>] <shop file> "
+              "<job file, - for standard input> <output schedule file> "
               "[<output job file>]" << std::endl;
     return 0;
   }
@@ -39,7 +49,7 @@ int PssSingleSiteMain(int argc, char **argv) {
   sched_filename = argv[3];
   jls_filename = (argc == 5) ? argv[4] : NULL;
   return PssSingleSiteSchedule(shop_filename, job_filename, sched_filename,
-                               jls_filename);
+                               jls_filename, (unsigned)num_threads);
 }
 
 int main(int argc, char **argv) {
@@ -0,0 +1,105 @@
+/*  pss_calendar.hpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  header file for precomputed calendar data used to speed up scheduling
+ */
+
+#ifndef PSS_CALENDAR_HPP_INCLUDED_
+#define PSS_CALENDAR_HPP_INCLUDED_
+
+#include "pss_utils.hpp"
+
+//number of seconds covered by one bit of a CalendarBitmap;
+//0 disables the bitmaps altogether
+#ifndef PSS_CALENDAR_BITMAP_RESOLUTION
+#define PSS_CALENDAR_BITMAP_RESOLUTION 60
+#endif
+
+namespace pss {
+
+//time slots of a resource compiled from its schedules; resources with the
+//same time slots share one (see ShopInfo::calendars), which is never
+//changed once shared
+struct Calendar {
+  TintvlVec2d weekts;
+  DayTs dayts;
+  CalendarKind kind;
+};
+
+typedef size_t CalendarId;
+
+//false if calendar time of at most 'open' seconds cannot hold 'secs' seconds
+//of work; the slack absorbs rounding in QuantityTest()
+inline bool MayHold(time_t open, double secs) {
+  return (double)open + 1.0 >= secs * (1.0 - 1e-9);
+}
+
+//one bit per PSS_CALENDAR_BITMAP_RESOLUTION seconds over [origin, horizon),
+//set iff the calendar may be open at some second within it
+//used to rule out gaps that cannot possibly hold a job before the
+//(much more expensive) exact QuantityTest()
+class CalendarBitmap {
+ public:
+  CalendarBitmap(void) : origin_(0), horizon_(0) {}
+
+  void Build(time_t from, time_t to, const TintvlVec2d &weekts,
+             const DayTs &dayts, const LocalTimeTable &localtime);
+
+  //bitmap of the times both calendars may be open; covers nothing unless
+  //both were built over the same range
+  void Intersect(const CalendarBitmap &bits1, const CalendarBitmap &bits2);
+
+  //upper bound on the number of open seconds in [start, end);
+  //returns numeric_limits<time_t>::max() if [start, end) is not covered
+  time_t OpenSecsUpperBound(time_t start, time_t end) const;
+
+ private:
+  void SetRange(time_t start, time_t end);
+
+  void BuildRanks(void);
+
+  //number of set bits before bit 'cell'
+  size_t Rank(size_t cell) const;
+
+  time_t origin_;
+  time_t horizon_;
+  std::vector<unsigned> bits_;
+  std::vector<unsigned> ranks_; //number of set bits before each word
+};
+
+//cells of PSS_CALENDAR_BITMAP_RESOLUTION seconds (aligned to the epoch) that
+//are fully taken by the intervals of a committed timeline; together with the
+//station's CalendarBitmap it gives the free capacity of the timeline
+class BusyBitmap {
+ public:
+  BusyBitmap(void) : base_(0), tintvls_(0) {}
+
+  //marks the cells fully covered by 'tintvl' as busy
+  void Occupy(const Tintvl &tintvl);
+
+  //true if all 'size' intervals of the timeline have gone through Occupy()
+  bool InSync(size_t size) const {
+    return tintvls_ == size;
+  }
+
+  //earliest time >= 'from' at which a stretch of free cells starts whose
+  //calendar time may hold 'secs' seconds of work; gaps of the timeline
+  //ending by then are too short for such work
+  time_t FirstFit(const CalendarBitmap &calbits, time_t from, double secs) const;
+
+ private:
+  bool Busy(time_t cell) const;
+
+  //first cell >= 'cell' with the given state; numeric_limits<time_t>::max()
+  //if there is no busy cell at or after 'cell'
+  time_t NextCell(time_t cell, bool busy) const;
+
+  time_t base_;  //word index (counted from the epoch) of bits_[0]
+  std::vector<unsigned> bits_;
+  size_t tintvls_;
+};
+
+}
+
+#endif // PSS_CALENDAR_HPP_INCLUDED_
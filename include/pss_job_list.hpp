@@ -11,6 +11,7 @@
 
 #include "pss_jobs_parser.hpp"
 #include "pss_shop_job.hpp"
+#include "pss_task_pool.hpp"
 
 namespace pss {
 class JobList {
@@ -20,11 +21,29 @@ class JobList {
   std::vector<ShopJob> jobs_;
 
  public:
-  JobList(const char *filename, const ShopInfo &shopinfo, const unsigned minjobid) {
+  //reads 'filename' ("-" for the standard input) one job at a time on a
+  //thread of 'pool', the other threads compiling the jobs read meanwhile
+  JobList(const char *filename, const ShopInfo &shopinfo, const unsigned minjobid,
+          TaskPool &pool);
+
+  //a list can also be built in steps s.t. several lists can be parsed
+  //before the ids of their jobs are known, and their jobs compiled in parts
+  JobList() : minjobid_(0) {}
+
+  void ParseFile(const char *filename) {
     JobsParser jobs_parser(model_);
     jobs_parser.ParseFile(filename);
+    jobs_.resize(model_.jobs.size());
+  }
+
+  void SetMinJobId(const unsigned minjobid) {
     this->minjobid_ = minjobid;
-    GetShopJobs(jobs_, model_.jobs, shopinfo, minjobid);
+  }
+
+  //compiles jobs [first, last) of the list for the shop of 'shopinfo'
+  void CompileJobs(const ShopInfo &shopinfo, size_t first, size_t last) {
+    for(size_t j = first; j < last; ++j)
+      GetShopJob(jobs_[j], model_.jobs[j], shopinfo, minjobid_ + (unsigned)j);
   }
 
   friend class Scheduler;
@@ -17,17 +17,17 @@ struct JobInfo {
   std::string jobid;
   std::string jobpartid;
   int priority;
-  std::string product;
+  pss::TextView product;
   int numbatches;
   bool isroute;
 };
 
 struct RsrcInfo {
-  std::string id;
+  pss::TextView id;
   int rsrclass;
-  std::string partnumber;
+  pss::TextView partnumber;
   int quality;
-  std::string media;
+  pss::TextView media;
 };
 
 struct Resource {
@@ -78,9 +78,11 @@ struct Job {
 };
 
 struct JobListModel {
+  //the text the views of the model point into (see JobsReader)
+  boost::shared_ptr<const void> source;
   pss::BaseInfo baseinfo;
-  std::string creator;
-  std::string version;
+  pss::TextView creator;
+  pss::TextView version;
   std::vector<pss::Job> jobs;
 };
 
@@ -9,6 +9,8 @@
 #ifndef PSS_JOBS_PARSER_HPP_INCLUDED_
 #define PSS_JOBS_PARSER_HPP_INCLUDED_
 
+#include <fstream>
+#include <list>
 #include "pss_jobs_file.hpp"
 
 namespace pss {
@@ -17,9 +19,45 @@ class JobsParser {
 
  public:
   JobsParser(JobListModel &model) : model_(model) { }
+  //reads all jobs of 'path' into the model through a JobsReader
   int ParseFile(char const *path);
 };
 
+//reads a job list one job at a time: the text is read from a stream in
+//blocks and each Job element is parsed on its own, s.t. the DOM of only
+//one job is held at any time. The text read is kept, as the views of the
+//model and of its jobs point into it
+class JobsReader {
+ public:
+  //opens 'path', "-" being the standard input, and reads the attributes of
+  //the list into 'model'
+  JobsReader(char const *path, JobListModel &model);
+
+  //reads the next job of the list into 'job', which must be empty; returns
+  //false once all jobs are read
+  bool ReadJob(Job &job);
+
+ private:
+  typedef std::list<std::vector<char> > TextBlocks;
+
+  JobsReader(const JobsReader &);
+
+  JobsReader &operator=(const JobsReader &);
+
+  //reads more text after 'end_', moving the text from 'pos_' on to a new
+  //block if the current one is full; returns false at the end of the stream
+  bool Fill(void);
+
+  std::string path_;
+  std::ifstream file_;
+  std::istream *is_;
+  boost::shared_ptr<TextBlocks> blocks_;
+  char *pos_;    //first character not read yet
+  char *end_;    //end of the text in the current block
+  char *limit_;  //end of the current block, less the room for terminators
+  bool done_;    //the end of the list was read
+};
+
 } // namespace pss
 
 #endif // PSS_JOBS_PARSER_HPP_INCLUDED_
@@ -0,0 +1,43 @@
+/*  pss_mapped_file.hpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  read-only memory mapping of the files parsed in place
+ */
+
+#ifndef PSS_MAPPED_FILE_HPP_INCLUDED_
+#define PSS_MAPPED_FILE_HPP_INCLUDED_
+
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace pss {
+
+//the contents of a file mapped into memory read-only and followed by a
+//'\0' s.t. rapidxml can parse them in place with parse_non_destructive;
+//a file whose size is a multiple of the page size leaves no room for the
+//'\0' in its mapping and is read into memory instead
+class MappedFile {
+ public:
+  explicit MappedFile(const char *path);
+
+  const char *data(void) const { return data_; }
+
+  size_t size(void) const { return size_; }
+
+ private:
+  MappedFile(const MappedFile &);
+
+  MappedFile &operator=(const MappedFile &);
+
+  boost::interprocess::file_mapping file_;
+  boost::interprocess::mapped_region region_;
+  std::vector<char> buffer_;
+  const char *data_;
+  size_t size_;
+};
+
+} // namespace pss
+
+#endif // PSS_MAPPED_FILE_HPP_INCLUDED_
@@ -27,7 +27,14 @@ class MultisiteJobList {
 
   void CompileOutsourceableJobs(const MultisiteShop &shop);
 
-  void CompileDefinition(const MultisiteShop &shop);
+  //translates job 'job_int_id' into 'shop_job', its entry for shop 'shop_id'
+  //in outsource_db_, unless done before; CompileOutsourceableJobs() only
+  //checks the capabilities of the shop s.t. jobs are translated only for
+  //the shops they are actually scheduled in
+  void TranslateOutsourcedJob(ShopJob &shop_job, unsigned job_int_id,
+                              unsigned shop_id, const MultisiteShop &shop) const;
+
+  void CompileDefinition(const MultisiteShop &shop, TaskPool &pool);
 
  public:
    int NumOfLists(void) const;
@@ -48,7 +55,8 @@ class MultisiteJobList {
 
    void ShopJobPointers(std::vector<pss::ShopJob *> &shop_job_pointers);
 
-   MultisiteJobList(const char *filename, const MultisiteShop &shop);
+   //loads the lists on 'pool'
+   MultisiteJobList(const char *filename, const MultisiteShop &shop, TaskPool &pool);
 
   friend class MultisiteScheduler;
 };
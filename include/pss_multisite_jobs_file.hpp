@@ -21,9 +21,11 @@ struct JobFile {
 };
 
 struct MultisiteJobListModel {
+  //the file the views of the model point into
+  boost::shared_ptr<const pss::MappedFile> source;
   pss::BaseInfo baseinfo;
-  std::string creator;
-  std::string version;
+  pss::TextView creator;
+  pss::TextView version;
   std::vector<pss::JobFile> jobfiles;
 };
 
@@ -9,13 +9,17 @@
 #ifndef PSS_MULTISITE_SCHEDULER_HPP_INCLUDED_
 #define PSS_MULTISITE_SCHEDULER_HPP_INCLUDED_
 
-#include <boost/thread.hpp>
 #include "pss_sched_utils.hpp"
+#include "pss_task_pool.hpp"
 #include "pss_multisite_job_list.hpp"
 
 namespace pss {
 class MultisiteScheduler {
  private:
+  //loads the shops and lists, and runs the lists, candidate shops and group
+  //trials that can be scheduled independently of each other; comes first
+  //s.t. it is there to load them
+  pss::TaskPool pool_;
   pss::MultisiteShop shop_;
   pss::MultisiteJobList job_list_;
   std::vector<std::map<unsigned, pss::Sched> > scheds_;
@@ -27,7 +31,6 @@ class MultisiteScheduler {
   std::string sched_filename_suffix_;
   std::string jls_filename_prefix_;
   std::string jls_filename_suffix_;
-  std::map<std::string, OrderFptr, CaseInsensitiveLess> seqpolicydict_;
   bool output_jls_files_;
 
   void FilenamePrefixSuffix(const char *filename, std::string &prefix,
@@ -48,9 +51,79 @@ class MultisiteScheduler {
 
   void ScheduleNonOutsourceableJobs(MultisiteScheduleContext &msc);
 
+  //a shop that can process a job of an outsourceable list
+  struct CandidateShop {
+    unsigned shop_id;
+    pss::ShopJob *shopJob;  //the job translated for the shop
+    pss::Sched sched;
+    time_t bound;  //lower bound on the completion time, delay included
+    bool scheduled;
+  };
+
+  //schedules the job of 'candidate' in its shop without committing it;
+  //touches no state of other shops s.t. candidates can be scheduled
+  //concurrently
+  void ScheduleCandidate(CandidateShop &candidate, const unsigned homeshop_id,
+                         std::vector<pss::Rsrc2Tintvl> &mach2tintvl,
+                         std::vector<pss::Rsrc2Tintvl> &opr2tintvl,
+                         const std::vector<pss::ShopJob *> &allShopJobPointers);
+
+  //an outsourceable list and the next of its jobs to be decided
+  struct OutsourceableList {
+    unsigned homeshop_id;
+    std::vector<pss::Job> *rawJobs;
+    unsigned firstShopJobIntId;
+    std::vector<pss::ShopJob *> jobs;  //in the order of the list's sequencing policy
+    //shops whose timelines the decision of each job may read: the home shop
+    //and the shops the job can be outsourced to
+    std::vector<std::vector<unsigned> > shopIds;
+    std::vector<unsigned> pending;  //number of undecided jobs per shop in shopIds
+    std::map<std::string, unsigned> pendingGroups;  //number of undecided jobs per group
+    size_t next;  //next job to be decided
+  };
+
+  //where to schedule the next job of 'list'
+  struct OutsourceDecision {
+    OutsourceableList *list;
+    std::vector<CandidateShop> candidates;
+    std::vector<size_t> order;  //indices of the candidates by bound
+  };
+
+  //constrains the job's group if needed and collects its candidate shops
+  //in the order of their bounds
+  void PrepareDecision(OutsourceDecision &decision,
+                       const std::vector<pss::Rsrc2Tintvl> &mach2tintvl,
+                       const std::vector<pss::Rsrc2Tintvl> &opr2tintvl,
+                       const std::vector<pss::ShopJob *> &allShopJobPointers);
+
+  //commits the job to the first of the candidates that complete it earliest
+  void CommitDecision(OutsourceDecision &decision,
+                      std::vector<pss::Rsrc2Tintvl> &mach2tintvl,
+                      std::vector<pss::Rsrc2Tintvl> &opr2tintvl);
+
+  //a trial of outsourcing all jobs of a group to one shop
+  struct GroupTrial {
+    unsigned shop_id;
+    time_t maxCompletionTime;  //latest completion of a job in the group
+  };
+
+  //schedules the jobs 'jobIds' of a group one after another on a scratch
+  //copy of the timelines of the trial's shop only; trials of different
+  //shops can run concurrently
+  void ScheduleGroupTrial(GroupTrial &trial,
+                          std::map<unsigned,
+                          std::map<unsigned, pss::ShopJob> > &outsourceDB,
+                          std::vector<pss::SchedStats> &stats,
+                          const std::set<unsigned> &jobIds,
+                          const unsigned homeshop_id,
+                          const pss::Rsrc2Tintvl &mach2tintvl,
+                          const pss::Rsrc2Tintvl &opr2tintvl,
+                          const std::vector<pss::ShopJob *> &allShopJobPointers);
+
  public:
   MultisiteScheduler(const char *msShopFileName, const char *msJobFileName,
-                     const char *msSchedFileName, const char *msJlsFileName);
+                     const char *msSchedFileName, const char *msJlsFileName,
+                     unsigned numThreads = 1);
 
   //greedily pick the best shop_ to outsource the first job within a group such that
   //all other, subsequent jobs in the same group are constrained to be outsourced to
@@ -9,8 +9,11 @@
 #ifndef PSS_MULTISITE_SHOP_HPP_INCLUDED_
 #define PSS_MULTISITE_SHOP_HPP_INCLUDED_
 
+#include <boost/dynamic_bitset.hpp>
+#include "pss_jobs_file.hpp"
 #include "pss_shop.hpp"
 #include "pss_multisite_shop_parser.hpp"
+#include "pss_task_pool.hpp"
 
 namespace pss {
 
@@ -20,9 +23,17 @@ class MultisiteShop {
   std::vector<Shop> shops_;
   std::map<std::string, unsigned> shop_ids_;
   std::vector<time_t> delay_matrix_;
+  //function names and resource units of all shops, each given a bit in the
+  //capability sets below
+  std::map<std::string, unsigned> func_bits_;
+  std::map<std::string, unsigned> unit_bits_;
+  std::vector<boost::dynamic_bitset<> > capabilities_;
+
+  void CompileCapabilities(void);
 
  public:
-  MultisiteShop(const char *filename);
+  //loads the shops on 'pool'
+  MultisiteShop(const char *filename, TaskPool &pool);
 
   unsigned GetShopId(const std::string &shopname) const;
 
@@ -30,11 +41,21 @@ class MultisiteShop {
 
   const Shop &GetShop(unsigned shop_id) const;
 
+  void PrepareCalendars(time_t from, time_t to);
+
   int NumOfShops(void) const;
 
   void ValidateDelayMatrix(void) const;
 
-  void CompileDefinition(void);
+  void CompileDefinition(TaskPool &pool);
+
+  //sets 'required' to the functions and resource units of 'job'; returns
+  //false if some of them are not supported by any shop
+  bool RequiredCapabilities(const Job &job, boost::dynamic_bitset<> &required) const;
+
+  //true if shop 'shop_id' supports all of 'required', i.e., if GetShopJob()
+  //can translate the job for the shop
+  bool IsCapable(unsigned shop_id, const boost::dynamic_bitset<> &required) const;
 
   time_t GetDelay(unsigned src_shop_id, unsigned dest_shop_id) const;
 
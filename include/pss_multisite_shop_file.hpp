@@ -27,9 +27,11 @@ struct ShopFile {
 };
 
 struct MultisiteShopModel {
+  //the file the views of the model point into
+  boost::shared_ptr<const pss::MappedFile> source;
   pss::BaseInfo baseinfo;
-  std::string creator;
-  std::string version;
+  pss::TextView creator;
+  pss::TextView version;
   std::vector<ShopFile> shopfiles;
   std::vector<InterShopDelay> delays;
 };
@@ -11,10 +11,21 @@
 
 #include <vector>
 #include <map>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <boost/variant.hpp>
+#include "pss_mapped_file.hpp"
 
 namespace pss {
 
+//how much of a file a parser puts in its model: kParseForScheduling leaves
+//out what the scheduler never reads (see ShopParser), kParseAll keeps
+//everything for tools that write the model back out
+enum ParseProfile {
+  kParseForScheduling,
+  kParseAll
+};
+
 struct Attribute {
   std::string name;
   std::string value;
@@ -47,11 +58,15 @@ struct Quantity {
   std::string unit;
 };
 
+//text only echoed back out stays in the parsed file as it is, the model
+//holding on to the file (see the 'source' of the models)
+typedef boost::string_ref TextView;
+
 struct BaseInfo {
   std::string name;
-  std::string type;
+  pss::TextView type;
   int status;
-  std::string comment;
+  pss::TextView comment;
 };
 
 struct Dimension {
@@ -9,21 +9,23 @@
 #ifndef PSS_PARSER_UTILS_HPP_INCLUDED_
 #define PSS_PARSER_UTILS_HPP_INCLUDED_
 
-#include <sstream>
 #include "rapidxml.hpp"
 #include "pss_parser.hpp"
 
 namespace pss {
 
-template<typename T>
+//'func' is called as func(rapidxml::xml_node<> *, T &), s.t. it can be
+//bound to further arguments (e.g. a ParseProfile)
+template<typename T, typename Func>
 void ParseVector(rapidxml::xml_node<> *node,
                  char const *name,
                  std::vector<T>  &v,
-                 void(*func)(rapidxml::xml_node<> *, T &)) {
+                 Func func) {
   for(rapidxml::xml_node<> *n = node->first_node(name);
       n;
       n = n->next_sibling(name)) {
-    T t;
+    //value-initialized, s.t. fields not parsed (e.g. PriceInfo) are 0
+    T t = T();
     func(n, t);
     v.push_back(t);
   }
@@ -43,17 +45,31 @@ void ParseVector2(rapidxml::xml_node<> *node,
   }
 }
 
+//read [first, last) the way 'std::istream >> value' does, without a
+//stream or any allocation: leading white space is skipped, a value out of
+//range is clamped, 'value' is 0 if no number starts there and is left as
+//it is if there is nothing but white space
+void ParseNumber(const char *first, const char *last, int &value);
+void ParseNumber(const char *first, const char *last, long &value);
+void ParseNumber(const char *first, const char *last, long long &value);
+void ParseNumber(const char *first, const char *last, double &value);
+
+//documents are parsed with parse_non_destructive (see ParseXmlFile()), so
+//attribute values are not terminated
 template<typename T>
 void ParseAttr(rapidxml::xml_node<> *node, char const *name, T &attr) {
-  std::stringstream ss;
   rapidxml::xml_attribute<> *attribute = node->first_attribute(name);
-  if(attribute) {
-    ss << attribute->value();
-    ss >> attr;
-  }
+  if(attribute)
+    ParseNumber(attribute->value(), attribute->value() + attribute->value_size(), attr);
 }
 
+//parses 'source' in place into 'doc'; the text of the document points
+//into 'source', which must outlive it
+void ParseXmlFile(rapidxml::xml_document<> &doc, const MappedFile &source);
+
 void ParseStrAttr(rapidxml::xml_node<> *node, char const *name, std::string &attr);
+//'attr' keeps the value as it is in the file, references included
+void ParseStrAttr(rapidxml::xml_node<> *node, char const *name, TextView &attr);
 void ParseBoolAttr(rapidxml::xml_node<> *node, char const *name, bool &attr);
 void ParseNameAttr(rapidxml::xml_node<> *node, std::string &name);
 void ParseIdAttr(rapidxml::xml_node<> *node, std::string &id);
@@ -0,0 +1,156 @@
+/*  pss_pool_alloc.hpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  node pool and pool allocator for long-lived interval containers
+ */
+
+#ifndef PSS_POOL_ALLOC_HPP_INCLUDED_
+#define PSS_POOL_ALLOC_HPP_INCLUDED_
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <boost/atomic.hpp>
+#if __cplusplus >= 201103L
+#include <type_traits>
+#endif
+
+namespace pss {
+
+//fixed-size node pool carved out of geometrically growing slabs;
+//freed nodes are recycled through a free list and all slabs are
+//released at once when the last allocator referring to the pool goes away
+//NOTE: allocators referring to a pool may be copied and destroyed on any
+//      thread, but nodes are allocated and freed without locking: the
+//      containers sharing a pool must only be modified by one thread at a time
+class NodePool {
+ public:
+  NodePool(void);
+
+  ~NodePool();
+
+  void *Allocate(size_t size);
+
+  void Deallocate(void *p, size_t size);
+
+  void AddRef(void) { refs_.fetch_add(1, boost::memory_order_relaxed); }
+
+  //drops a reference to 'pool', deleting it with the last one
+  static void Release(NodePool *pool);
+
+ private:
+  struct FreeNode {
+    FreeNode *next;
+  };
+
+  NodePool(const NodePool &);
+
+  NodePool &operator=(const NodePool &);
+
+  void Grow(void);
+
+  size_t node_size_;    //fixed by the first request; 0 until then
+  size_t slab_nodes_;   //number of nodes in the next slab
+  std::vector<char *> slabs_;
+  FreeNode *free_list_;
+  char *cur_;           //unused part of the newest slab
+  char *end_;
+  boost::atomic<unsigned> refs_;
+};
+
+//allocator drawing single nodes from a shared NodePool;
+//a default-constructed allocator has no pool and uses the global heap
+template <typename T>
+class PoolAllocator {
+ public:
+  typedef T value_type;
+  typedef T *pointer;
+  typedef const T *const_pointer;
+  typedef T &reference;
+  typedef const T &const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template <typename U>
+  struct rebind {
+    typedef PoolAllocator<U> other;
+  };
+
+  PoolAllocator(void) : pool_(NULL) {}
+
+  //takes ownership of a newly created pool
+  explicit PoolAllocator(NodePool *pool) : pool_(pool) { }
+
+  PoolAllocator(const PoolAllocator &other) : pool_(other.pool_) {
+    if(pool_)
+      pool_->AddRef();
+  }
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U> &other) : pool_(other.pool()) {
+    if(pool_)
+      pool_->AddRef();
+  }
+
+  ~PoolAllocator() {
+    if(pool_)
+      NodePool::Release(pool_);
+  }
+
+  PoolAllocator &operator=(const PoolAllocator &other) {
+    if(other.pool_)
+      other.pool_->AddRef();
+    if(pool_)
+      NodePool::Release(pool_);
+    pool_ = other.pool_;
+    return *this;
+  }
+
+  NodePool *pool(void) const { return pool_; }
+
+  pointer address(reference x) const { return &x; }
+
+  const_pointer address(const_reference x) const { return &x; }
+
+  pointer allocate(size_type n, const void * = 0) {
+    if(pool_ && n == 1)
+      return static_cast<pointer>(pool_->Allocate(sizeof(T)));
+    return static_cast<pointer>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(pointer p, size_type n) {
+    if(pool_ && n == 1)
+      pool_->Deallocate(p, sizeof(T));
+    else
+      ::operator delete(p);
+  }
+
+  size_type max_size(void) const { return size_t(-1) / sizeof(T); }
+
+  void construct(pointer p, const T &val) { new(p) T(val); }
+
+  void destroy(pointer p) { p->~T(); }
+
+#if __cplusplus >= 201103L
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+#endif
+
+ private:
+  NodePool *pool_;
+};
+
+template <typename T, typename U>
+inline bool operator==(const PoolAllocator<T> &a, const PoolAllocator<U> &b) {
+  return a.pool() == b.pool();
+}
+
+template <typename T, typename U>
+inline bool operator!=(const PoolAllocator<T> &a, const PoolAllocator<U> &b) {
+  return a.pool() != b.pool();
+}
+
+} // namespace pss
+
+#endif // PSS_POOL_ALLOC_HPP_INCLUDED_
@@ -10,14 +10,15 @@
 #define PSS_SCHED_UTILS_HPP_INCLUDED_
 
 #include "pss_shop_job.hpp"
+#include "pss_symbol.hpp"
 
 namespace pss {
 
 struct Fstep {
-  std::string funcseq;
-  std::string cell;
-  std::string station;
-  std::string opr;
+  Symbol funcseq;
+  Symbol cell;
+  Symbol station;
+  Symbol opr;
   unsigned seqid;  //index to corresponding funcseqs[] in Job
 };
 
@@ -25,13 +26,32 @@ typedef std::vector<Fstep> Route;
 
 typedef unsigned StepId;
 
-typedef std::map<std::string, TintvlSet> Rsrc2Tintvl;
+//timeline of a resource; 'busy' follows the intervals committed through
+//InsertMachTintvl(Rsrc2Tintvl &, const Sched &) (see BusyBitmap::InSync())
+struct RsrcTintvls : public TintvlSet {
+  RsrcTintvls(void) {}
+
+  //takes ownership of a newly created pool
+  explicit RsrcTintvls(NodePool *pool) :
+    TintvlSet(LtTintvl(), PoolAllocator<Tintvl>(pool)) {}
+
+  BusyBitmap busy;
+};
+
+typedef std::map<std::string, RsrcTintvls> Rsrc2Tintvl;
+
+//returns the timeline of 'rsrc', giving it its own node pool on first use
+//s.t. intervals of the same resource are allocated close together
+RsrcTintvls &ResourceTintvls(Rsrc2Tintvl &rsrc2tintvl, const std::string &rsrc);
+
+//quantities produced in the corresponding mach_tintvls[] of a step
+typedef SmallVector<int, 1> StepQuantities;
 
 struct SchedStep {
   Fstep step;
-  std::vector<Tintvl> mach_tintvls;
-  std::vector<Tintvl> opr_tintvls;
-  std::vector<int> quantities;
+  StepTintvls mach_tintvls;
+  StepTintvls opr_tintvls;
+  StepQuantities quantities;
 };
 
 typedef std::vector<SchedStep> Sched;
@@ -66,6 +86,7 @@ struct SchedStats { // schedule statistics
   time_t end; // end time of the last job
   time_t makespan; // = end - start
   double cpu_sec; // cpu seconds spent by the scheduler
+  double wall_sec; // wall-clock seconds spent by the scheduler (multi-site only)
 };
 
 struct CaseInsensitiveLess : std::binary_function<std::string, std::string, bool> {
@@ -82,20 +103,39 @@ struct CaseInsensitiveLess : std::binary_function<std::string, std::string, bool
   }
 };
 
-typedef bool (*OrderFptr)(const ShopJob *, const ShopJob *);
+//the fields of a ShopJob compared by the sequencing policies, packed
+//together s.t. sorting jobs touches neither their strings nor their
+//function sequences
+struct JobSortKey {
+  time_t arrival;
+  time_t due;
+  time_t proctime;
+  unsigned attrrank; //rank of the attributes of the job's function sequences
+  ShopJob *job;
+};
 
 int FindMinhopRoutes(std::vector<Route> &routes,
                      std::vector<Func> const &funcseqs,
-                     One2Many const &seq2cell);
+                     Seq2Cells const &seq2cell);
 
 void ScheduleJob(Sched &sched, ShopJob *shopJob, unsigned priority,
                  Rsrc2Tintvl &mach2tintvl, Rsrc2Tintvl &opr2tintvl,
                  const ShopInfo &shopInfo,
                  const std::vector<ShopJob *> &all_job_ptrs);
 
+//lower bound on the completion time of 'shopJob' found by ScheduleJob(),
+//whatever the load of the shop: a step starts no earlier than the arrival
+//and the steps producing its inputs, and takes at least as long as its
+//smallest batch on an idle station of the step with no setup. Returns
+//the arrival if the job cannot be routed in the shop
+time_t CompletionLowerBound(const ShopJob *shopJob, const ShopInfo &shopInfo);
+
 void CommitSchedule(const Sched &sched, Rsrc2Tintvl &mach2tintvl,
                     Rsrc2Tintvl &opr2tintvl);
 
+//extends [from, to] to cover the arrival and due times of all 'shop_jobs'
+void JobsHorizon(const std::vector<ShopJob> &shop_jobs, time_t &from, time_t &to);
+
 void DoSchedule(std::map<unsigned, Sched> &scheds,
                 std::vector<ShopJob> &shop_jobs,
                 const ShopInfo &shopInfo, Rsrc2Tintvl &mach2tintvl,
@@ -126,7 +166,11 @@ void WriteScheduleEvents(std::vector<Job *> &rawjobs,
 void ShopJobPointers(std::vector<ShopJob *> &shop_job_pointers,
                      std::vector<ShopJob> &shop_jobs);
 
-void InitSeqPolicyDict(std::map<std::string, OrderFptr, CaseInsensitiveLess> &dict);
+//sorts 'shop_job_ptrs' in the order given by 'sequencepolicy' (one of
+//firstInFirstOut, earliestDue, leastSlack and shortestProcTime), comparing
+//JobSortKey's instead of the jobs
+void SortShopJobs(std::vector<ShopJob *> &shop_job_ptrs,
+                  const std::string &sequencepolicy);
 
 } // namespace pss
 
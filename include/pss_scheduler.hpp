@@ -17,6 +17,9 @@ namespace pss {
 
 class Scheduler {
  protected:
+  //reads the job list while compiling its jobs; comes first s.t. it is
+  //there to load them
+  TaskPool pool_;
   Shop shop_;
   JobList job_list_;
   std::map<unsigned, Sched> scheds_;
@@ -25,8 +28,10 @@ class Scheduler {
   SchedStats stats_;
 
  public:
+  //'job_filename' may be "-" for the standard input
   Scheduler(const char *shop_filename, const char *job_filename,
-            const char *sched_filename, const char *jls_filename);
+            const char *sched_filename, const char *jls_filename,
+            unsigned num_threads = 1);
   void Run(void);
   void PrintInfo(std::ostream &os);
 };
@@ -12,6 +12,7 @@
 #include <fstream>
 #include "pss_shop_parser.hpp"
 #include "pss_shop_func.hpp"
+#include "pss_shop_cache.hpp"
 #include "pss_exception.hpp"
 
 namespace pss {
@@ -22,15 +23,40 @@ class Shop {
   ShopInfo info_;
 
  public:
+  Shop() {}
+
   Shop(std::string const &filename) {
+    Load(filename);
+  }
+
+  //parses 'filename' and compiles the shop from it, unless the shop cache
+  //has the image of the shop compiled from the same contents (see
+  //ShopImagePath()), in which case the model is left empty
+  void Load(std::string const &filename) {
+    boost::shared_ptr<const MappedFile> source(new MappedFile(filename.c_str()));
+    boost::uint64_t shophash = HashText(source->data(), source->size());
+    std::string image = ShopImagePath(shophash);
+    if(!image.empty() && LoadShopImage(info_, image, shophash))
+      return;
     ShopParser shop_parser(model_);
-    shop_parser.ParseFile(filename.c_str());
+    shop_parser.ParseFile(source);
     GetShopInfo(info_, model_);
+    if(!image.empty())
+      SaveShopImage(info_, image, shophash);
   }
 
   const ShopInfo &GetInfo(void) const {
     return info_;
   }
+
+  //must be called before scheduling jobs within [from, to]; the calendar
+  //data built here is only ever read by the scheduler of this shop
+  void PrepareCalendars(time_t from, time_t to) {
+    info_.localtime = LocalTimeTable();
+    if(from <= to)
+      BuildLocalTimeTable(info_.localtime, from - 86400, to + 2 * 366 * 86400);
+    BuildCalendarBitmaps(info_, from, to);
+  }
 };
 
 } // namespace pss
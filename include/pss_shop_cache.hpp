@@ -0,0 +1,41 @@
+/*  pss_shop_cache.hpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  binary images of compiled shops, s.t. a shop file is parsed and
+ *  compiled again only once it changes
+ */
+
+#ifndef PSS_SHOP_CACHE_HPP_INCLUDED_
+#define PSS_SHOP_CACHE_HPP_INCLUDED_
+
+#include <string>
+#include <boost/cstdint.hpp>
+#include "pss_shop_func.hpp"
+
+namespace pss {
+
+//64-bit FNV-1a hash of [data, data + size)
+boost::uint64_t HashText(const char *data, size_t size);
+
+//image of the shop compiled from a shop file hashing to 'shophash', in the
+//directory given by the environment variable PSS_SHOP_CACHE_DIR; empty if
+//the variable is not set, which disables the cache
+std::string ShopImagePath(boost::uint64_t shophash);
+
+//reads the compiled shop from the image 'path' into 'shop_info'; returns
+//false, leaving 'shop_info' as it is, if there is no such image or it is
+//not one of a shop file hashing to 'shophash' written by this version of
+//the scheduler, or is damaged
+bool LoadShopImage(ShopInfo &shop_info, const std::string &path,
+                   boost::uint64_t shophash);
+
+//writes the image of 'shop_info', compiled from a shop file hashing to
+//'shophash', to 'path'; the image replaces any other at once, s.t. other
+//processes see either one in whole. Returns false if it cannot be written
+bool SaveShopImage(const ShopInfo &shop_info, const std::string &path,
+                   boost::uint64_t shophash);
+
+} // namespace pss
+
+#endif // PSS_SHOP_CACHE_HPP_INCLUDED_
@@ -95,9 +95,11 @@ struct Cell {
 };
 
 struct ShopModel {
+  //the file the views of the model point into
+  boost::shared_ptr<const pss::MappedFile> source;
   pss::BaseInfo baseinfo;
-  std::string creator;
-  std::string version;
+  pss::TextView creator;
+  pss::TextView version;
   pss::Config config;
   std::vector<pss::Schedule> schds;
   std::vector<pss::Station> stations;
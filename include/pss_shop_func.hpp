@@ -10,13 +10,14 @@
 #define PSS_SHOP_FUNC_HPP_INCLUDED_
 
 #include <iostream>
-#include "pss_utils.hpp"
+#include "pss_calendar.hpp"
 #include "pss_shop_file.hpp"
+#include "pss_symbol.hpp"
 
 namespace pss {
 
 struct Sfunc {
-  std::string station;
+  Symbol station;
   SimpleFunc funcseq;
 };
 
@@ -30,15 +31,29 @@ typedef std::set<Sfunc, LtSfunc> SfuncSet;
 
 typedef std::map<std::string,  SfuncSet> Seq2Sfunc;
 
+//names of operators and cells are interned when the shop is compiled,
+//s.t. scheduling fills in steps by copying Symbols only
+typedef std::set<Symbol> SymbolSet;
+
+typedef std::map<std::string, SymbolSet> One2Symbols;
+
+//cells that can run a function sequence, along with its interned name
+struct SeqCells {
+  Symbol funcseq;
+  SymbolSet cells;
+};
+
+typedef std::map<std::string, SeqCells> Seq2Cells;
+
 struct ShopInfo {
   std::map<std::string, pss::Seq2Sfunc> seq2mach;
-  std::map<std::string, pss::TintvlVec2d> mach2weekts;
-  std::map<std::string, pss::DayTs> mach2dayts;
+  //distinct calendars of the shop, interned by content
+  std::vector<pss::Calendar> calendars;
+  std::map<std::string, pss::CalendarId> mach2cal;
   std::map<std::string, std::map<std::string, SimpleFunc> > station2seq;
-  pss::One2Many cell2opr;
-  std::map<std::string, pss::One2Many> seq2opr;
-  std::map<std::string, pss::TintvlVec2d> opr2weekts;
-  std::map<std::string, pss::DayTs> opr2dayts;
+  pss::One2Symbols cell2opr;
+  std::map<std::string, pss::One2Symbols> seq2opr;
+  std::map<std::string, pss::CalendarId> opr2cal;
   std::map<std::string, pss::CellConfig> cell2config;
   std::map<std::string, pss::Rsrc2Qty> unit2minbatch;
   std::map<std::string, double> rsrc2speed;
@@ -46,12 +61,35 @@ struct ShopInfo {
   pss::One2Many seq2func;
   pss::One2Many func2sameseqfunc;
   pss::One2One machfuncseq2id;
-  pss::One2Many seq2cell;
+  pss::Seq2Cells seq2cell;
   Config config;
+  //filled by Shop::PrepareCalendars() once the scheduling horizon is known
+  pss::LocalTimeTable localtime;
+  //filled by BuildCalendarBitmaps() once the scheduling horizon is known;
+  //indexed by CalendarId
+  std::vector<pss::CalendarBitmap> calbits;
+  //intersections of the station and operator calendars that can go together
+  //in cells using operator schedules, keyed by (station, operator) CalendarId
+  std::map<std::pair<pss::CalendarId, pss::CalendarId>,
+           pss::CalendarBitmap> calpair2bits;
 };
 
+//calendar of station 'station', which must exist
+inline const Calendar &MachCalendar(const ShopInfo &shop_info,
+                                    const std::string &station) {
+  return shop_info.calendars[shop_info.mach2cal.find(station)->second];
+}
+
+//calendar of operator 'opr', which must exist
+inline const Calendar &OprCalendar(const ShopInfo &shop_info,
+                                   const std::string &opr) {
+  return shop_info.calendars[shop_info.opr2cal.find(opr)->second];
+}
+
 void GetShopInfo(ShopInfo &shop_info, ShopModel &shop);
 
+void BuildCalendarBitmaps(ShopInfo &shop_info, time_t from, time_t to);
+
 void PrintShopConfig(std::ostream &os, const ShopInfo &shop_info);
 
 void PrintMultiFuncSeq(std::ostream &os, pss::One2Many &seq2func);
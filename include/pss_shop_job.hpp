@@ -43,11 +43,6 @@ struct ShopJob {
 void GetShopJob(pss::ShopJob &shop_job, const pss::Job &job,
                 const pss::ShopInfo &shop_info, const unsigned job_int_id);
 
-void GetShopJobs(std::vector<pss::ShopJob> &shop_jobs,
-                 const std::vector<pss::Job> &jobs,
-                 const pss::ShopInfo &shop_info,
-                 const unsigned min_job_int_id);
-
 }
 
 #endif // PSS_SHOP_JOB_HPP_INCLUDED_
@@ -15,10 +15,18 @@ namespace pss {
 
 class ShopParser {
   ShopModel &shopmodel_;
+  ParseProfile profile_;
 
  public:
-  ShopParser(ShopModel &shopmodel) : shopmodel_(shopmodel) { }
+  //with kParseForScheduling, station geometries, mttf, mttr and
+  //HighCapacity, function SpeedVariation and Quality, as well as cell ids,
+  //control policies and the cell assignment policy are not read but set
+  //to 0, false or empty
+  ShopParser(ShopModel &shopmodel, ParseProfile profile = kParseForScheduling)
+    : shopmodel_(shopmodel), profile_(profile) { }
   int ParseFile(char const *path);
+  //parses the shop file already mapped as 'source'
+  int ParseFile(const boost::shared_ptr<const MappedFile> &source);
 };
 
 } // namespace pss
@@ -0,0 +1,148 @@
+/*  pss_small_vector.hpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  vector with inline storage for its first few elements
+ */
+
+#ifndef PSS_SMALL_VECTOR_HPP_INCLUDED_
+#define PSS_SMALL_VECTOR_HPP_INCLUDED_
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace pss {
+
+//subset of std::vector for copyable value types that keeps up to N elements
+//inside the object and only goes to the heap beyond that; used for the
+//per-step intervals and quantities of a schedule, which mostly hold one
+template <typename T, unsigned N>
+class SmallVector {
+ public:
+  typedef T value_type;
+  typedef T *iterator;
+  typedef const T *const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef size_t size_type;
+
+  SmallVector(void) : data_(inline_), size_(0), capacity_(N) {}
+
+  SmallVector(const SmallVector &other)
+    : data_(inline_), size_(0), capacity_(N) {
+    insert(end(), other.begin(), other.end());
+  }
+
+  //takes over the heap storage of 'other', if any
+  SmallVector(SmallVector &&other) noexcept
+    : data_(inline_), size_(0), capacity_(N) {
+    Steal(other);
+  }
+
+  ~SmallVector() {
+    if(data_ != inline_)
+      delete [] data_;
+  }
+
+  SmallVector &operator=(const SmallVector &other) {
+    if(this != &other) {
+      size_ = 0;
+      insert(end(), other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  SmallVector &operator=(SmallVector &&other) noexcept {
+    if(this != &other) {
+      if(data_ != inline_)
+        delete [] data_;
+      data_ = inline_;
+      capacity_ = N;
+      Steal(other);
+    }
+    return *this;
+  }
+
+  iterator begin(void) { return data_; }
+  const_iterator begin(void) const { return data_; }
+  iterator end(void) { return data_ + size_; }
+  const_iterator end(void) const { return data_ + size_; }
+  reverse_iterator rbegin(void) { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin(void) const { return const_reverse_iterator(end()); }
+  reverse_iterator rend(void) { return reverse_iterator(begin()); }
+  const_reverse_iterator rend(void) const { return const_reverse_iterator(begin()); }
+
+  size_type size(void) const { return size_; }
+  bool empty(void) const { return size_ == 0; }
+
+  T &operator[](size_type i) { return data_[i]; }
+  const T &operator[](size_type i) const { return data_[i]; }
+  T &front(void) { return data_[0]; }
+  const T &front(void) const { return data_[0]; }
+  T &back(void) { return data_[size_ - 1]; }
+  const T &back(void) const { return data_[size_ - 1]; }
+
+  void clear(void) { size_ = 0; }
+
+  void push_back(const T &value) {
+    if(size_ == capacity_) {
+      T copy = value; //'value' may live in the storage about to be freed
+      Reserve(2 * capacity_);
+      data_[size_++] = copy;
+    } else
+      data_[size_++] = value;
+  }
+
+  //new elements are value-initialized as in std::vector
+  void resize(size_type size) {
+    Reserve(size);
+    for(; size_ < size; ++size_)
+      data_[size_] = T();
+    size_ = (unsigned)size;
+  }
+
+  //only appending at end() is supported
+  template <typename InputIterator>
+  void insert(iterator pos, InputIterator first, InputIterator last) {
+    for(; first != last; ++first)
+      push_back(*first);
+  }
+
+ private:
+  //leaves 'other' empty
+  void Steal(SmallVector &other) {
+    if(other.data_ != other.inline_) {
+      data_ = other.data_;
+      capacity_ = other.capacity_;
+      other.data_ = other.inline_;
+      other.capacity_ = N;
+    } else {
+      for(unsigned i = 0; i < other.size_; ++i)
+        inline_[i] = other.inline_[i];
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+  }
+
+  void Reserve(size_type capacity) {
+    if(capacity <= capacity_)
+      return;
+    T *data = new T[capacity];
+    for(unsigned i = 0; i < size_; ++i)
+      data[i] = data_[i];
+    if(data_ != inline_)
+      delete [] data_;
+    data_ = data;
+    capacity_ = (unsigned)capacity;
+  }
+
+  T inline_[N];
+  T *data_;
+  unsigned size_;
+  unsigned capacity_;
+};
+
+} // namespace pss
+
+#endif // PSS_SMALL_VECTOR_HPP_INCLUDED_
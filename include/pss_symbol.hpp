@@ -0,0 +1,65 @@
+/*  pss_symbol.hpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  interned strings for the names of schedule steps
+ */
+
+#ifndef PSS_SYMBOL_HPP_INCLUDED_
+#define PSS_SYMBOL_HPP_INCLUDED_
+
+#include <iostream>
+#include <string>
+
+namespace pss {
+
+//name interned in a process-wide pool: a Symbol is a single pointer,
+//copying one never allocates and equal names share the same string;
+//converts implicitly to the string it stands for and orders like it
+class Symbol {
+ public:
+  Symbol(void) : str_(Empty()) {}
+
+  Symbol(const std::string &str) : str_(Intern(str)) {}
+
+  Symbol(const char *str) : str_(Intern(str)) {}
+
+  const std::string &str(void) const { return *str_; }
+
+  operator const std::string &(void) const { return *str_; }
+
+  bool empty(void) const { return str_->empty(); }
+
+  const char *c_str(void) const { return str_->c_str(); }
+
+  bool operator==(const Symbol &rhs) const { return str_ == rhs.str_; }
+
+  bool operator!=(const Symbol &rhs) const { return str_ != rhs.str_; }
+
+  bool operator<(const Symbol &rhs) const {
+    return str_ != rhs.str_ && *str_ < *rhs.str_;
+  }
+
+ private:
+  static const std::string *Intern(const std::string &str);
+
+  static const std::string *Empty(void);
+
+  const std::string *str_;
+};
+
+inline bool operator==(const Symbol &lhs, const std::string &rhs) {
+  return lhs.str() == rhs;
+}
+
+inline bool operator!=(const Symbol &lhs, const std::string &rhs) {
+  return lhs.str() != rhs;
+}
+
+inline std::ostream &operator<<(std::ostream &os, const Symbol &symbol) {
+  return os << symbol.str();
+}
+
+} // namespace pss
+
+#endif // PSS_SYMBOL_HPP_INCLUDED_
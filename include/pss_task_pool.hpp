@@ -0,0 +1,67 @@
+/*  pss_task_pool.hpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  bounded pool of threads running batches of scheduling tasks
+ */
+
+#ifndef PSS_TASK_POOL_HPP_INCLUDED_
+#define PSS_TASK_POOL_HPP_INCLUDED_
+
+#include <exception>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+namespace pss {
+
+//runs batches of independent tasks on a fixed number of threads, the
+//calling thread being one of them; with a single thread all tasks run on
+//the calling thread in the order given
+class TaskPool {
+ public:
+  typedef boost::function<void (void)> Task;
+
+  explicit TaskPool(unsigned num_threads);
+
+  ~TaskPool();
+
+  unsigned NumThreads(void) const { return (unsigned)workers_.size() + 1; }
+
+  //runs all 'tasks' and returns once they have finished; rethrows the
+  //exception of the first of the tasks, in the order given, that threw
+  //NOTE: not reentrant; tasks must not call Run() themselves
+  void Run(std::vector<Task> &tasks);
+
+ private:
+  TaskPool(const TaskPool &);
+
+  TaskPool &operator=(const TaskPool &);
+
+  void Work(void);
+
+  //runs tasks of the current batch until none is left unclaimed
+  void RunTasks(boost::mutex::scoped_lock &lock);
+
+  std::vector<boost::thread *> workers_;
+  boost::mutex mutex_;
+  boost::condition_variable batch_ready_;
+  boost::condition_variable batch_done_;
+  std::vector<Task> *batch_;  //NULL if there is no batch to work on
+  size_t next_;               //next unclaimed task of the batch
+  size_t unfinished_;         //tasks of the batch not finished yet
+  unsigned batch_id_;         //tells workers a new batch from the last one
+  std::exception_ptr error_;
+  size_t error_task_;         //task that threw 'error_'
+  bool stop_;
+};
+
+//CPU seconds used by the calling thread so far
+double ThreadCpuSeconds(void);
+
+//seconds elapsed on a monotonic clock since some fixed point in time
+double WallSeconds(void);
+
+} // namespace pss
+
+#endif // PSS_TASK_POOL_HPP_INCLUDED_
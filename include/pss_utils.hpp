@@ -10,9 +10,12 @@
 #define PSS_UTILS_HPP_INCLUDED_
 
 #include <stdarg.h>
+#include <bitset>
 #include <set>
 #include <time.h>
 #include "pss_parser.hpp"
+#include "pss_pool_alloc.hpp"
+#include "pss_small_vector.hpp"
 
 namespace pss {
 
@@ -33,7 +36,85 @@ struct LtTintvl {
   }
 };
 
-typedef std::set<Tintvl, LtTintvl> TintvlSet;
+//intervals of one schedule step, usually a single one
+typedef SmallVector<Tintvl, 1> StepTintvls;
+
+//long-lived timelines get a NodePool attached (see ResourceTintvls());
+//all other sets allocate from the global heap as usual
+typedef std::set<Tintvl, LtTintvl, PoolAllocator<Tintvl> > TintvlSet;
+
+//read-only, ordered view of the union of two TintvlSets (as computed by
+//std::set_union) that avoids copying either set; used to scan a station's
+//committed timeline together with the job's own tentative intervals
+class TintvlUnion {
+ public:
+  class const_iterator {
+   public:
+    const_iterator(void) : set1_(NULL), set2_(NULL) {}
+
+    const Tintvl &operator*(void) const { return FromFirst() ? *i1_ : *i2_; }
+
+    const Tintvl *operator->(void) const { return &**this; }
+
+    const_iterator &operator++(void);
+
+    const_iterator operator++(int) {
+      const_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    const_iterator &operator--(void);
+
+    bool operator==(const const_iterator &other) const {
+      return i1_ == other.i1_ && i2_ == other.i2_;
+    }
+
+    bool operator!=(const const_iterator &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class TintvlUnion;
+
+    const_iterator(const TintvlSet *set1, TintvlSet::const_iterator i1,
+                   const TintvlSet *set2, TintvlSet::const_iterator i2) :
+      set1_(set1), set2_(set2), i1_(i1), i2_(i2) {}
+
+    //ties go to set1 (the duplicate in set2 is skipped)
+    bool FromFirst(void) const {
+      return i2_ == set2_->end() ||
+             (i1_ != set1_->end() && !(i2_->start < i1_->start));
+    }
+
+    const TintvlSet *set1_;
+    const TintvlSet *set2_;
+    TintvlSet::const_iterator i1_;
+    TintvlSet::const_iterator i2_;
+  };
+
+  TintvlUnion(const TintvlSet &set1, const TintvlSet &set2) :
+    set1_(set1), set2_(set2) {}
+
+  bool empty(void) const { return set1_.empty() && set2_.empty(); }
+
+  const_iterator begin(void) const {
+    return const_iterator(&set1_, set1_.begin(), &set2_, set2_.begin());
+  }
+
+  const_iterator end(void) const {
+    return const_iterator(&set1_, set1_.end(), &set2_, set2_.end());
+  }
+
+  const_iterator upper_bound(const Tintvl &tintvl) const {
+    return const_iterator(&set1_, set1_.upper_bound(tintvl),
+                          &set2_, set2_.upper_bound(tintvl));
+  }
+
+ private:
+  const TintvlSet &set1_;
+  const TintvlSet &set2_;
+};
 
 struct LtDay {
   bool operator()(const Day &day1, const Day &day2) const {
@@ -51,16 +132,47 @@ struct LtDay {
   }
 };
 
+//packs a std tm day into an integer that orders like LtDay
+inline int DayKey(const Day &stdtm_day) {
+  return (stdtm_day.year * 16 + stdtm_day.month) * 32 + stdtm_day.day;
+}
+
+//key of the day of the year, regardless of the year
+inline int YearDayKey(const Day &stdtm_day) {
+  return stdtm_day.month * 32 + stdtm_day.day;
+}
+
+//time slots of special days, all in one pool: the day keys[i] has the
+//slots [firsts[i], firsts[i + 1]) of 'slots'
 //tintvls must be sorted
-typedef std::map<Day, std::vector<Tintvl>, LtDay> DayMap;
+struct DayIndex {
+  std::vector<int> keys;
+  std::vector<size_t> firsts;
+  std::vector<Tintvl> slots;
+};
 
 struct DayTs {
-  DayMap once;
-  DayMap everyyear;
+  DayIndex once;      //keyed by DayKey()
+  DayIndex everyyear; //keyed by YearDayKey()
+  //set for the YearDayKey() of every special day of either kind
+  std::bitset<12 * 32> yeardays;
+
+  bool empty(void) const {
+    return once.keys.empty() && everyyear.keys.empty();
+  }
+
+  void clear(void) {
+    once = everyyear = DayIndex();
+    yeardays.reset();
+  }
 };
 
 typedef std::vector<std::vector<Tintvl> > TintvlVec2d;
 
+//kAlwaysOpen: open around the clock every day of the week, no special days
+//kWeeklyOnly: weekly time slots only, no special days
+enum CalendarKind { kAlwaysOpen, kWeeklyOnly, kSpecialDays };
+
 typedef std::map<std::string, std::string> One2One;
 
 typedef std::map<std::string, std::set<std::string> > One2Many;
@@ -92,6 +204,34 @@ void GetTmslot247(TintvlVec2d &weekts, DayTs &dayts);
 
 tm *LocaltimeSafe(const time_t *timep, tm *result);
 
+//UTC offsets of the local time zone over [starts.front(), end): offsets[i]
+//applies from starts[i] on; built once per scheduling run (see
+//Shop::PrepareCalendars()) and read-only afterwards
+struct LocalTimeTable {
+  LocalTimeTable(void) : end(0) {}
+
+  time_t end;
+  std::vector<time_t> starts;
+  std::vector<time_t> offsets;
+};
+
+/* precomputes the UTC offsets of the local time zone over [from, to), s.t.
+ * LocalDayTime() needs no libc time call (or its lock) within that range
+ */
+void BuildLocalTimeTable(LocalTimeTable &table, const time_t from,
+                         const time_t to);
+
+//local day time (seconds since midnight), week day and std tm day of "time";
+//times not covered by "table" (e.g. an empty one) are left to the C library
+void LocalDayTime(const time_t time, time_t &daytime, int &weekday,
+                  Day &stdtm_day, const LocalTimeTable &table);
+
+void EarliestUnitRsrcTintvl(Tintvl &tintvl, time_t &time, time_t &daytime,
+                            Day &stdtm_day, const DayTs &dayts, int &weekday,
+                            const TintvlVec2d &weekts);
+
+CalendarKind GetCalendarKind(const TintvlVec2d &weekts, const DayTs &dayts);
+
 tm *GmtimeSafe(const time_t *timep, tm *result);
 
 char *AsctimeSafe(const tm *timeptr, char *buf, unsigned bufsize);
@@ -100,9 +240,10 @@ bool QuantityTest(const int quantity, const double unitdur, const time_t setup0,
                   const time_t setup1, const bool is_first_batch,
                   const time_t start, const time_t end,
                   const TintvlVec2d &weekts, const DayTs &dayts,
-                  time_t &actualEnd);
+                  const LocalTimeTable &localtime, time_t &actualEnd,
+                  const CalendarKind kind = kSpecialDays);
 
-void EarliestSlot(std::vector<Tintvl> &tintvls,
+void EarliestSlot(StepTintvls &tintvls,
                   const unsigned jobintid,
                   const unsigned seqid,
                   const bool is_first_batch,
@@ -112,7 +253,9 @@ void EarliestSlot(std::vector<Tintvl> &tintvls,
                   const int quantity,
                   const double unitdur,
                   const TintvlVec2d &weekts,
-                  const DayTs &dayts);
+                  const DayTs &dayts,
+                  const LocalTimeTable &localtime,
+                  const CalendarKind kind = kSpecialDays);
 
 bool QuantityTestOprltd(const int quantity, const double unitdur,
                         const time_t setup0,  const time_t setup1,
@@ -121,10 +264,12 @@ bool QuantityTestOprltd(const int quantity, const double unitdur,
                         const DayTs &machdayts, const int oprdemand,
                         const TintvlSet &oprtintvls,
                         const TintvlVec2d &oprweekts,
-                        const DayTs &oprdayts, time_t &actualEnd);
+                        const DayTs &oprdayts, const LocalTimeTable &localtime,
+                        time_t &actualEnd,
+                        const CalendarKind machkind = kSpecialDays);
 
-void EarliestSlotOprltd(std::vector<Tintvl> &machsteptintvls,
-                        std::vector<Tintvl> &oprsteptintvls,
+void EarliestSlotOprltd(StepTintvls &machsteptintvls,
+                        StepTintvls &oprsteptintvls,
                         const unsigned jobintid,
                         const unsigned seqid,
                         const bool is_first_batch,
@@ -138,8 +283,11 @@ void EarliestSlotOprltd(std::vector<Tintvl> &machsteptintvls,
                         const int oprdemand,
                         TintvlSet &oprtintvls,
                         const TintvlVec2d &oprweekts,
-                        const DayTs &oprdayts);
+                        const DayTs &oprdayts,
+                        const LocalTimeTable &localtime,
+                        const CalendarKind machkind = kSpecialDays);
 
+//for debugging only; local times are left to the C library
 time_t timespan(const time_t start, const time_t end, const TintvlVec2d &weekts,
                 const DayTs &dayts);
 
@@ -163,22 +311,22 @@ void TranslateHtmlStr(std::string &str);
 void TintvlSetAdd(const TintvlSet &set1, const TintvlSet &set2,
                   TintvlSet &result);
 
-void TintvlSetAdd(const TintvlSet &set1, const std::vector<Tintvl> &set2,
+void TintvlSetAdd(const TintvlSet &set1, const StepTintvls &set2,
                   TintvlSet &result);
 
-void TintvlSetAdd(TintvlSet &set1, const std::vector<Tintvl> &set2);
+void TintvlSetAdd(TintvlSet &set1, const StepTintvls &set2);
 
 void TintvlSetSubtract(const TintvlSet &set1, const TintvlSet &set2,
                        TintvlSet &result);
 
-void TintvlSetSubtract(const TintvlSet &set1, const std::vector<Tintvl> &set2,
+void TintvlSetSubtract(const TintvlSet &set1, const StepTintvls &set2,
                        TintvlSet &result);
 
-void TintvlSetSubtract(TintvlSet &set1, const std::vector<Tintvl> &set2);
+void TintvlSetSubtract(TintvlSet &set1, const StepTintvls &set2);
 
 void TintvlSetSimplify(TintvlSet &tintvls);
 
-void TintvlSetSimplify(std::vector<Tintvl> &tintvls);
+void TintvlSetSimplify(StepTintvls &tintvls);
 
 }
 
@@ -0,0 +1,234 @@
+/*  pss_calendar.cpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  implementation file for precomputed calendar data
+ */
+#include <assert.h>
+#include <limits>
+#include "pss_calendar.hpp"
+
+using namespace std;
+
+namespace pss {
+
+static const time_t kBitmapRes = PSS_CALENDAR_BITMAP_RESOLUTION;
+static const unsigned kWordBits = 32;
+//same for signed (epoch-based) cell arithmetic
+static const time_t kWordCells = kWordBits;
+
+static inline unsigned PopCount(unsigned word) {
+#ifdef __GNUC__
+  return __builtin_popcount(word);
+#else
+  unsigned count;
+  for(count = 0; word; ++count)
+    word &= word - 1;
+  return count;
+#endif
+}
+
+//index of the lowest set bit of a non-zero word
+static inline unsigned LowestBit(unsigned word) {
+#ifdef __GNUC__
+  return __builtin_ctz(word);
+#else
+  unsigned bit;
+  for(bit = 0; !(word & 1u); ++bit)
+    word >>= 1;
+  return bit;
+#endif
+}
+
+static inline time_t FloorDiv(time_t a, time_t b) {
+  return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+//seconds of local day time at "time"
+static time_t DayTime(time_t time, const LocalTimeTable &localtime) {
+  time_t daytime;
+  int weekday;
+  Day stdtm_day;
+
+  LocalDayTime(time, daytime, weekday, stdtm_day, localtime);
+  return daytime;
+}
+
+void CalendarBitmap::SetRange(time_t start, time_t end) {
+  if(start < origin_)
+    start = origin_;
+  if(end >= horizon_)
+    end = horizon_ - 1;
+  if(start > end)
+    return;
+  size_t c0 = (size_t)((start - origin_) / kBitmapRes);
+  size_t c1 = (size_t)((end - origin_) / kBitmapRes);
+  for(size_t c = c0; c <= c1; ++c)
+    bits_[c / kWordBits] |= 1u << (c % kWordBits);
+}
+
+void CalendarBitmap::Build(time_t from, time_t to, const TintvlVec2d &weekts,
+                           const DayTs &dayts,
+                           const LocalTimeTable &localtime) {
+  int weekday;
+  time_t time, daytime, slack;
+  Tintvl tintvl;
+  Day stdtm_day;
+  bool open = false;
+
+  origin_ = horizon_ = from;
+  bits_.clear();
+  ranks_.assign(1, 0);
+  if(kBitmapRes <= 0 || to <= from)
+    return;
+  //a calendar without weekly slots may never open again;
+  //leave the bitmap empty rather than risk an endless walk
+  for(TintvlVec2d::const_iterator w = weekts.begin(); w != weekts.end(); ++w)
+    open = open || !w->empty();
+  if(!open)
+    return;
+  size_t cells = (size_t)((to - from + kBitmapRes - 1) / kBitmapRes);
+  horizon_ = from + (time_t)cells * kBitmapRes;
+  bits_.assign((cells + kWordBits - 1) / kWordBits, 0);
+  //calendar walks advance whole 86400-second days, so slots found past a
+  //DST change can be off by the change in UTC offset (both here and in the
+  //walk being bounded); widen every slot by twice the largest such change
+  //within the horizon to keep the bound safe
+  daytime = DayTime(from, localtime);
+  slack = 0;
+  for(time = from; time < horizon_; time += 86400) {
+    time_t shift = DayTime(time, localtime) - daytime;
+    if(shift > 43200)
+      shift -= 86400;
+    else if(shift <= -43200)
+      shift += 86400;
+    if(shift < 0)
+      shift = -shift;
+    if(2 * shift > slack)
+      slack = 2 * shift;
+  }
+  for(time = from; time < horizon_;) {
+    time_t est = time;
+    LocalDayTime(time, daytime, weekday, stdtm_day, localtime);
+    EarliestUnitRsrcTintvl(tintvl, est, daytime, stdtm_day, dayts, weekday, weekts);
+    assert(tintvl.start >= time && tintvl.end >= tintvl.start);
+    if(tintvl.start - slack >= horizon_)
+      break;
+    SetRange(tintvl.start - slack, tintvl.end + slack);
+    time = tintvl.end + 1;
+  }
+  BuildRanks();
+}
+
+void CalendarBitmap::Intersect(const CalendarBitmap &bits1,
+                               const CalendarBitmap &bits2) {
+  origin_ = horizon_ = bits1.origin_;
+  bits_.clear();
+  ranks_.assign(1, 0);
+  if(bits1.origin_ != bits2.origin_ || bits1.horizon_ != bits2.horizon_ ||
+     bits1.horizon_ == bits1.origin_)
+    return;
+  horizon_ = bits1.horizon_;
+  bits_.resize(bits1.bits_.size());
+  for(size_t w = 0; w < bits_.size(); ++w)
+    bits_[w] = bits1.bits_[w] & bits2.bits_[w];
+  BuildRanks();
+}
+
+void CalendarBitmap::BuildRanks(void) {
+  ranks_.resize(bits_.size() + 1);
+  for(size_t w = 0; w < bits_.size(); ++w)
+    ranks_[w + 1] = ranks_[w] + PopCount(bits_[w]);
+}
+
+size_t CalendarBitmap::Rank(size_t cell) const {
+  size_t w = cell / kWordBits, rank = ranks_[w];
+  if(cell % kWordBits)
+    rank += PopCount(bits_[w] & ((1u << (cell % kWordBits)) - 1));
+  return rank;
+}
+
+time_t CalendarBitmap::OpenSecsUpperBound(time_t start, time_t end) const {
+  if(start < origin_ || end > horizon_)
+    return numeric_limits<time_t>::max();
+  if(end <= start)
+    return 0;
+  size_t c0 = (size_t)((start - origin_) / kBitmapRes);
+  size_t c1 = (size_t)((end - 1 - origin_) / kBitmapRes);
+  time_t cells = (time_t)(Rank(c1 + 1) - Rank(c0));
+  return min(cells * kBitmapRes, end - start);
+}
+
+void BusyBitmap::Occupy(const Tintvl &tintvl) {
+  ++tintvls_;
+  if(kBitmapRes <= 0)
+    return;
+  time_t c0 = FloorDiv(tintvl.start + kBitmapRes - 1, kBitmapRes);
+  time_t c1 = FloorDiv(tintvl.end + 1, kBitmapRes) - 1;
+  if(c0 > c1)
+    return;
+  time_t w0 = FloorDiv(c0, kWordCells), w1 = FloorDiv(c1, kWordCells);
+  if(bits_.empty())
+    base_ = w0;
+  if(w0 < base_) {
+    bits_.insert(bits_.begin(), (size_t)(base_ - w0), 0u);
+    base_ = w0;
+  }
+  if(w1 >= base_ + (time_t)bits_.size())
+    bits_.resize((size_t)(w1 - base_ + 1), 0u);
+  for(time_t c = c0; c <= c1; ++c) {
+    time_t w = FloorDiv(c, kWordCells);
+    bits_[(size_t)(w - base_)] |= 1u << (c - w * kWordCells);
+  }
+}
+
+bool BusyBitmap::Busy(time_t cell) const {
+  time_t w = FloorDiv(cell, kWordCells);
+  if(w < base_ || w >= base_ + (time_t)bits_.size())
+    return false;
+  return (bits_[(size_t)(w - base_)] >> (cell - w * kWordCells)) & 1u;
+}
+
+time_t BusyBitmap::NextCell(time_t cell, bool busy) const {
+  time_t w = FloorDiv(cell, kWordCells) - base_, size = (time_t)bits_.size();
+  unsigned word;
+
+  if(w >= size)
+    return busy ? numeric_limits<time_t>::max() : cell;
+  if(w < 0) {
+    if(!busy)
+      return cell;
+    w = 0;
+    cell = base_ * kWordCells;
+  }
+  word = busy ? bits_[(size_t)w] : ~bits_[(size_t)w];
+  word &= ~0u << (cell - (base_ + w) * kWordCells);
+  while(!word) {
+    if(++w == size)
+      return busy ? numeric_limits<time_t>::max() : (base_ + w) * kWordCells;
+    word = busy ? bits_[(size_t)w] : ~bits_[(size_t)w];
+  }
+  return (base_ + w) * kWordCells + LowestBit(word);
+}
+
+time_t BusyBitmap::FirstFit(const CalendarBitmap &calbits, time_t from,
+                            double secs) const {
+  time_t start = from, cell, end;
+
+  if(kBitmapRes <= 0)
+    return from;
+  cell = FloorDiv(from, kBitmapRes);
+  //'from' inside committed work: leave it to the caller
+  if(Busy(cell))
+    return from;
+  for(;;) {
+    end = NextCell(cell, true);
+    if(end == numeric_limits<time_t>::max() ||
+       MayHold(calbits.OpenSecsUpperBound(start, end * kBitmapRes), secs))
+      return start;
+    cell = NextCell(end, false);
+    start = cell * kBitmapRes;
+  }
+}
+
+} // namespace pss
@@ -5,7 +5,9 @@
  *
  * implementation file for pss single-site filler scheduler
  */
+#include <iterator>
 #include <limits>
+#include <utility>
 #include "pss_filler_scheduler.hpp"
 #include "pss_jobs_writer.hpp"
 
@@ -21,7 +23,7 @@ FillerScheduler::FillerScheduler(const char *shop_filename,
                                  const time_t min_delta_t_,
                                  const time_t max_delta_t_) :
   Scheduler(shop_filename, job_filename, sched_filename, jls_filename),
-  filler_job_pattern_(filler_job_filename, shop_.GetInfo(), 0),
+  filler_job_pattern_(filler_job_filename, shop_.GetInfo(), 0, pool_),
   num_jobs_filled_(0), min_delta_t_(min_delta_t_), max_delta_t_(max_delta_t_) {
   time_t min_arrival_t = numeric_limits<time_t>::max();
   vector<ShopJob>::iterator it;
@@ -55,7 +57,7 @@ void FillerScheduler::InsertFillerJobs(JobList &job_list,
     Job newJob(*j);
     ShiftDate(newJob.arrival, shift_t);
     ShiftDate(newJob.due, shift_t);
-    job_list.model_.jobs.push_back(newJob);
+    job_list.model_.jobs.push_back(std::move(newJob));
   }
   vector<ShopJob>::const_iterator sj;
   for(sj = filler_job_pattern_.jobs_.begin();
@@ -66,7 +68,7 @@ void FillerScheduler::InsertFillerJobs(JobList &job_list,
     newShopJob.due += shift_t;
     newShopJob.intid += shift_id;
     //may trigger realloc that invalidates the pointers
-    job_list.jobs_.push_back(newShopJob);
+    job_list.jobs_.push_back(std::move(newShopJob));
     //shop_job_pointers.push_back(&job_list.jobs.back()); cannot do this, see above
     //do this from scratch in case realloc occurred
     job_list.ShopJobPointers(shop_job_pointers);
@@ -91,6 +93,9 @@ void FillerScheduler::Run(void) {
   vector<ShopJob *> shop_job_pointers;
   job_list_.ShopJobPointers(shop_job_pointers);
   clock_t start = clock();
+  time_t from = numeric_limits<time_t>::max(), to = numeric_limits<time_t>::min();
+  JobsHorizon(jobs, from, to);
+  shop_.PrepareCalendars(from, to);
   DoSchedule(scheds_, jobs, shopInfo, mach2tintvl, opr2tintvl, shop_job_pointers);
   GetSchedStats(stats_, shop_job_pointers, mach2tintvl);
   time_t fillerStart;
@@ -129,9 +134,10 @@ void FillerScheduler::Run(void) {
     }
     //final commit
     if(success) {
-      mach2tintvl = mach2tintvlTmp;
-      opr2tintvl = opr2tintvlTmp;
-      scheds_.insert(fillerScheds.begin(), fillerScheds.end());
+      mach2tintvl.swap(mach2tintvlTmp);
+      opr2tintvl.swap(opr2tintvlTmp);
+      scheds_.insert(make_move_iterator(fillerScheds.begin()),
+                     make_move_iterator(fillerScheds.end()));
       ++num_jobs_filled_;
       if(num_jobs_filled_ > 1)
         sumDeltaT += (double)(fillerStart - prevFillerJobStartTime);
@@ -0,0 +1,150 @@
+/*  pss_job_list.cpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  implementation file for pss job list
+ */
+
+#include <iterator>
+#include <list>
+#include "pss_job_list.hpp"
+
+using namespace std;
+
+namespace pss {
+
+//jobs read in a row, compiled together
+static const size_t kJobsPerChunk = 256;
+
+struct JobChunk {
+  size_t first;  //index of the first job of the chunk in the list
+  vector<Job> jobs;
+  vector<ShopJob> shop_jobs;
+};
+
+//chunks read but not compiled yet, passed from the reader to the compilers
+class JobChunkQueue {
+ public:
+  JobChunkQueue() : closed_(false), error_first_(0) {}
+
+  void Push(JobChunk *chunk) {
+    boost::mutex::scoped_lock lock(mutex_);
+    chunks_.push_back(chunk);
+    ready_.notify_one();
+  }
+
+  //no more chunks will be pushed
+  void Close(void) {
+    boost::mutex::scoped_lock lock(mutex_);
+    closed_ = true;
+    ready_.notify_all();
+  }
+
+  //returns NULL once the queue is closed and empty
+  JobChunk *Pop(void) {
+    boost::mutex::scoped_lock lock(mutex_);
+    while(chunks_.empty() && !closed_)
+      ready_.wait(lock);
+    if(chunks_.empty())
+      return NULL;
+    JobChunk *chunk = chunks_.front();
+    chunks_.pop_front();
+    return chunk;
+  }
+
+  //keeps the error of the first job of the list that failed to compile
+  void Fail(const JobChunk &chunk, exception_ptr error) {
+    boost::mutex::scoped_lock lock(mutex_);
+    if(!error_ || chunk.first < error_first_) {
+      error_ = error;
+      error_first_ = chunk.first;
+    }
+  }
+
+  void RethrowError(void) {
+    if(error_)
+      rethrow_exception(error_);
+  }
+
+ private:
+  boost::mutex mutex_;
+  boost::condition_variable ready_;
+  list<JobChunk *> chunks_;
+  bool closed_;
+  exception_ptr error_;
+  size_t error_first_;
+};
+
+//Helper function
+static void ReadJobChunks(JobsReader &reader, list<JobChunk> &chunks,
+                          JobChunkQueue &queue) {
+  try {
+    for(size_t first = 0; ; first += kJobsPerChunk) {
+      chunks.push_back(JobChunk());
+      JobChunk &chunk = chunks.back();
+      chunk.first = first;
+      chunk.jobs.reserve(kJobsPerChunk);
+      while(chunk.jobs.size() < kJobsPerChunk) {
+        chunk.jobs.push_back(Job());
+        if(!reader.ReadJob(chunk.jobs.back())) {
+          chunk.jobs.pop_back();
+          break;
+        }
+      }
+      queue.Push(&chunk);
+      if(chunk.jobs.size() < kJobsPerChunk)
+        break;
+    }
+  } catch(...) {
+    queue.Close();
+    throw;
+  }
+  queue.Close();
+}
+
+//Helper function
+static void CompileJobChunks(JobChunkQueue &queue, const ShopInfo &shopinfo,
+                             const unsigned minjobid) {
+  while(JobChunk *chunk = queue.Pop()) {
+    //the jobs of a chunk are compiled in order, s.t. the first job that
+    //fails is that of the earliest chunk failing
+    try {
+      chunk->shop_jobs.resize(chunk->jobs.size());
+      for(size_t j = 0; j < chunk->jobs.size(); ++j)
+        GetShopJob(chunk->shop_jobs[j], chunk->jobs[j], shopinfo,
+                   minjobid + (unsigned)(chunk->first + j));
+    } catch(...) {
+      queue.Fail(*chunk, current_exception());
+    }
+  }
+}
+
+JobList::JobList(const char *filename, const ShopInfo &shopinfo,
+                 const unsigned minjobid, TaskPool &pool) : minjobid_(minjobid) {
+  JobsReader reader(filename, model_);
+  list<JobChunk> chunks;
+  JobChunkQueue queue;
+  //the reader comes first, s.t. with a single thread all jobs are read
+  //before being compiled
+  vector<TaskPool::Task> tasks;
+  tasks.push_back([&reader, &chunks, &queue] {
+    ReadJobChunks(reader, chunks, queue);
+  });
+  for(unsigned t = 1; t < max(pool.NumThreads(), 2u); ++t)
+    tasks.push_back([&queue, &shopinfo, minjobid] {
+      CompileJobChunks(queue, shopinfo, minjobid);
+    });
+  pool.Run(tasks);
+  queue.RethrowError();
+  size_t size = 0;
+  for(list<JobChunk>::iterator c = chunks.begin(); c != chunks.end(); ++c)
+    size += c->jobs.size();
+  model_.jobs.reserve(size);
+  jobs_.reserve(size);
+  for(list<JobChunk>::iterator c = chunks.begin(); c != chunks.end(); ++c) {
+    move(c->jobs.begin(), c->jobs.end(), back_inserter(model_.jobs));
+    move(c->shop_jobs.begin(), c->shop_jobs.end(), back_inserter(jobs_));
+  }
+}
+
+} // namespace pss
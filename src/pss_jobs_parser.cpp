@@ -5,9 +5,12 @@
  *
  *  implementation file pss jobs parser
  */
-#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
 #include "pss_jobs_parser.hpp"
 #include "pss_parser_utils.hpp"
+#include "pss_exception.hpp"
 
 using namespace std;
 using namespace rapidxml;
@@ -119,22 +122,195 @@ void ParseJob(xml_node<> *node, Job &job) {
 }
 
 int JobsParser::ParseFile(char const *path) {
-  ifstream file(path);
-  //read the entire file into buf
-  std::vector<char> buf((istreambuf_iterator<char>(file)),
-                        istreambuf_iterator<char>());
-  buf.push_back('\0');
-  xml_document<> doc;
-  //Parse the string pointed to by 'buf'
-  doc.parse<0>(&buf[0]);
-  //Obtain the jobs node
-  xml_node<> *jobsnode = doc.first_node("JobList");
-  ParseBaseInfo(jobsnode, model_.baseinfo);
-  ParseStrAttr(jobsnode, "Creator", model_.creator);
-  ParseStrAttr(jobsnode, "Version", model_.version);
+  JobsReader reader(path, model_);
   //Parse jobs
-  ParseVector<Job>(jobsnode, "Job", model_.jobs, ParseJob);
+  model_.jobs.push_back(Job());
+  while(reader.ReadJob(model_.jobs.back()))
+    model_.jobs.push_back(Job());
+  model_.jobs.pop_back();
   return 0;
 }
 
+//size of the blocks the text is read in
+static const size_t kBlockSize = 1 << 20;
+//room left after a block for terminating an element (see ParseElement())
+static const size_t kTerminatorRoom = 2;
+//characters needed to tell the kind of markup at '<' ("<![CDATA[");
+//the end tag of the list follows whatever is read before it
+static const ptrdiff_t kMarkupLookahead = 9;
+
+//Helper function
+static char *Search(char *p, char *end, char const *str) {
+  size_t len = strlen(str);
+  char *found = search(p, end, str, str + len);
+  return found == end ? NULL : found + len;
+}
+
+//Helper function
+static char *SkipQuoted(char *p, char *end) {
+  return static_cast<char *>(memchr(p + 1, *p, end - p - 1));
+}
+
+//returns the end of the markup starting at 'p', or NULL if it does not
+//end before 'end'; a start tag is taken alone
+static char *MarkupEnd(char *p, char *end) {
+  if(end - p < kMarkupLookahead)
+    return NULL;
+  if(p[1] == '?')
+    return Search(p + 2, end, "?>");
+  if(strncmp(p, "<!--", 4) == 0)
+    return Search(p + 4, end, "-->");
+  if(strncmp(p, "<![CDATA[", 9) == 0)
+    return Search(p + 9, end, "]]>");
+  //a start or end tag, or a declaration with its internal subset
+  int brackets = 0;
+  for(char *q = p + 1; q < end; ++q) {
+    if(*q == '"' || *q == '\'') {
+      q = SkipQuoted(q, end);
+      if(q == NULL)
+        return NULL;
+    } else if(*q == '[') {
+      ++brackets;
+    } else if(*q == ']') {
+      --brackets;
+    } else if(*q == '>' && brackets <= 0) {
+      return q + 1;
+    }
+  }
+  return NULL;
+}
+
+//Helper function
+static bool IsStartTag(char const *p, char const *markupend) {
+  return p[1] != '?' && p[1] != '!' && p[1] != '/' && markupend[-2] != '/';
+}
+
+//returns the end of the element, or other markup, starting at 'p', or
+//NULL if it does not end before 'end'
+static char *ContentEnd(char *p, char *end) {
+  char *q = MarkupEnd(p, end);
+  if(q == NULL || !IsStartTag(p, q))
+    return q;
+  for(int depth = 1; depth > 0;) {
+    p = static_cast<char *>(memchr(q, '<', end - q));
+    if(p == NULL)
+      return NULL;
+    q = MarkupEnd(p, end);
+    if(q == NULL)
+      return NULL;
+    if(p[1] == '/')
+      --depth;
+    else if(IsStartTag(p, q))
+      ++depth;
+  }
+  return q;
+}
+
+//Helper function
+static bool HasName(char const *p, char const *name) {
+  size_t len = strlen(name);
+  return strncmp(p + 1, name, len) == 0 &&
+         p[1 + len] != '\0' && strchr(" \t\r\n/>", p[1 + len]) != NULL;
+}
+
+//parses the element [first, last) in place into 'doc'; with 'starttag' the
+//element is only the start tag, parsed as an empty one. The characters
+//terminating the element for rapidxml are restored afterwards
+static void ParseElement(xml_document<> &doc, char *first, char *last, bool starttag) {
+  char saved[3] = { last[-1], last[0], last[1] };
+  if(starttag) {
+    last[-1] = '/';
+    last[0] = '>';
+    last[1] = '\0';
+  } else
+    last[0] = '\0';
+  try {
+    //as ParseXmlFile(), the text is not modified but for the terminators
+    doc.parse<parse_non_destructive>(first);
+  } catch(...) {
+    memcpy(last - 1, saved, sizeof(saved));
+    throw;
+  }
+  memcpy(last - 1, saved, sizeof(saved));
+}
+
+JobsReader::JobsReader(char const *path, JobListModel &model) :
+  path_(path), is_(&cin), blocks_(new TextBlocks), pos_(NULL), end_(NULL),
+  limit_(NULL), done_(false) {
+  if(path_ != "-") {
+    file_.open(path, ios::in | ios::binary);
+    if(!file_)
+      throw RuntimeException("Unable to open file: " + path_);
+    is_ = &file_;
+  }
+  model.source = blocks_;
+  //Skip the prolog up to the JobList start tag
+  for(;;) {
+    char *p = pos_ ? static_cast<char *>(memchr(pos_, '<', end_ - pos_)) : NULL;
+    pos_ = p ? p : end_;
+    char *q = p ? MarkupEnd(p, end_) : NULL;
+    if(q == NULL) {
+      if(!Fill())
+        throw RuntimeException("No job list in file: " + path_);
+      continue;
+    }
+    pos_ = q;
+    if(p[1] == '?' || p[1] == '!')
+      continue;
+    if(!HasName(p, "JobList"))
+      throw RuntimeException("No job list in file: " + path_);
+    done_ = !IsStartTag(p, q);
+    xml_document<> doc;
+    ParseElement(doc, p, q, !done_);
+    //Obtain the jobs node
+    xml_node<> *jobsnode = doc.first_node("JobList");
+    ParseBaseInfo(jobsnode, model.baseinfo);
+    ParseStrAttr(jobsnode, "Creator", model.creator);
+    ParseStrAttr(jobsnode, "Version", model.version);
+    return;
+  }
+}
+
+bool JobsReader::ReadJob(Job &job) {
+  while(!done_) {
+    char *p = static_cast<char *>(memchr(pos_, '<', end_ - pos_));
+    pos_ = p ? p : end_;
+    char *q = p ? ContentEnd(p, end_) : NULL;
+    if(q == NULL) {
+      if(!Fill())
+        throw RuntimeException("Unexpected end of job list in file: " + path_);
+      continue;
+    }
+    pos_ = q;
+    if(p[1] == '/') {
+      done_ = true;
+    } else if(p[1] != '?' && p[1] != '!' && HasName(p, "Job")) {
+      //the DOM of the job goes away with 'doc'
+      xml_document<> doc;
+      ParseElement(doc, p, q, false);
+      ParseJob(doc.first_node("Job"), job);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool JobsReader::Fill(void) {
+  if(end_ == limit_) {
+    //views point into the full block, which is kept
+    size_t pending = end_ - pos_;
+    size_t size = max(kBlockSize, 2 * pending);
+    blocks_->push_back(vector<char>(size + kTerminatorRoom));
+    char *block = &blocks_->back()[0];
+    if(pending > 0)
+      memcpy(block, pos_, pending);
+    pos_ = block;
+    end_ = block + pending;
+    limit_ = block + size;
+  }
+  is_->read(end_, limit_ - end_);
+  end_ += is_->gcount();
+  return is_->gcount() > 0;
+}
+
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
  *  implementation file for pss jobs writer
  */
 #include <iostream>
+#include <iterator>
 #include "pss_jobs_file.hpp"
 
 using namespace std;
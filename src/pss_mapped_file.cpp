@@ -0,0 +1,44 @@
+/*  pss_mapped_file.cpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  implementation file for the read-only memory mapping of files
+ */
+
+#include <fstream>
+#include "pss_mapped_file.hpp"
+#include "pss_exception.hpp"
+
+using namespace std;
+using namespace boost::interprocess;
+
+namespace pss {
+
+MappedFile::MappedFile(const char *path) : data_(NULL), size_(0) {
+  ifstream file(path, ios::in | ios::binary | ios::ate);
+  if(!file)
+    throw RuntimeException(string("Unable to open file: ") + path);
+  size_ = (size_t)file.tellg();
+  //the rest of the last page of a mapping reads as zeros
+  if(size_ % mapped_region::get_page_size() != 0) {
+    try {
+      file_mapping mapping(path, read_only);
+      mapped_region region(mapping, read_only);
+      file_.swap(mapping);
+      region_.swap(region);
+      data_ = static_cast<const char *>(region_.get_address());
+      return;
+    } catch(interprocess_exception &) {
+      //read it instead
+    }
+  }
+  buffer_.resize(size_ + 1);
+  file.seekg(0);
+  file.read(&buffer_[0], size_);
+  if(!file)
+    throw RuntimeException(string("Unable to read file: ") + path);
+  buffer_[size_] = '\0';
+  data_ = &buffer_[0];
+}
+
+} // namespace pss
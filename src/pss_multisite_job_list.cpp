@@ -6,15 +6,20 @@
  *  implementation file for pss multi-site job list
  */
 
+#include <cassert>
+#include <utility>
 #include "pss_multisite_job_list.hpp"
 
 using namespace std;
 
 namespace pss {
 
+//jobs of a list compiled by one task
+static const size_t kJobsPerTask = 256;
+
 void MultisiteJobList::CompileOutsourceableJobs(const MultisiteShop &shop) {
   unsigned num_of_shops = shop.NumOfShops();
-  ShopJob shopJob;
+  boost::dynamic_bitset<> required;
   bool firstJobInGroup;
   set<unsigned> shopIdsForFirstJobInGroup;
   unsigned listId = 0;
@@ -27,8 +32,9 @@ void MultisiteJobList::CompileOutsourceableJobs(const MultisiteShop &shop) {
     vector<ShopJob>::const_iterator sj;
     if(IsOutsourceableList(listId)) {
       const unsigned homeshop_id = home_shop_ids_[listId];
-      map<unsigned, ShopJob> shop2job;
       for(j = list.begin(), sj = jobs.begin(); j != list.end(); ++j, ++sj) {
+        //jobs are added untranslated; see TranslateOutsourcedJob()
+        map<unsigned, ShopJob> shop2job;
         if(!sj->group.empty()) {
           group2job_ids_[sj->group].insert(sj->intid);
           if(group2shop_ids_.find(sj->group) != group2shop_ids_.end())
@@ -40,25 +46,20 @@ void MultisiteJobList::CompileOutsourceableJobs(const MultisiteShop &shop) {
         } else
           firstJobInGroup = false;
         unsigned job_int_id = sj->intid;
+        bool supported = shop.RequiredCapabilities(*j, required);
         for(unsigned shop_id = 0; shop_id < num_of_shops; ++shop_id) {
           if(shop_id != homeshop_id) {
-            bool exception = false;
-            try {
-              GetShopJob(shopJob, *j, shop.GetShop(shop_id).GetInfo(), job_int_id);
-            } catch(RuntimeException) {
-              exception = true;
-            }
-            if(!exception) {
+            if(supported && shop.IsCapable(shop_id, required)) {
               if(sj->group.empty())   //no grouping information -> no such constraints
-                shop2job[shop_id] = shopJob;
+                shop2job[shop_id];
               else if(!firstJobInGroup) {
                 if(group2shop_ids_[sj->group].find(shop_id) != group2shop_ids_[sj->group].end())
-                  shop2job[shop_id] = shopJob; //the shop can process all jobs so far
+                  shop2job[shop_id]; //the shop can process all jobs so far
               } else { //first job in its group
-                shop2job[shop_id] = shopJob; //all capable shops are considered OK for now
+                shop2job[shop_id]; //all capable shops are considered OK for now
                 shopIdsForFirstJobInGroup.insert(shop_id);
               }
-            } else if(!sj->group.empty() && !firstJobInGroup) { //exception == true
+            } else if(!sj->group.empty() && !firstJobInGroup) { //shop not capable
               if(group2shop_ids_[sj->group].find(shop_id) != group2shop_ids_[sj->group].end()) {
                 group2shop_ids_[sj->group].erase(shop_id); //remove ineligible shop_id
               }
@@ -107,13 +108,29 @@ void MultisiteJobList::CompileOutsourceableJobs(const MultisiteShop &shop) {
   }
 }
 
-void MultisiteJobList::CompileDefinition(const MultisiteShop &shop) {
+void MultisiteJobList::TranslateOutsourcedJob(ShopJob &shop_job, unsigned job_int_id,
+                                              unsigned shop_id,
+                                              const MultisiteShop &shop) const {
+  //GetShopJob() gives every job with steps at least one function sequence
+  if(!shop_job.funcseqs.empty())
+    return;
+  for(vector<JobList>::const_iterator it = lists_.begin(); it != lists_.end(); ++it) {
+    const vector<ShopJob> &jobs(it->GetJobs());
+    if(!jobs.empty() && job_int_id - jobs[0].intid < jobs.size()) {
+      GetShopJob(shop_job, it->GetList().jobs[job_int_id - jobs[0].intid],
+                 shop.GetShop(shop_id).GetInfo(), job_int_id);
+      return;
+    }
+  }
+  assert(false);
+}
+
+void MultisiteJobList::CompileDefinition(const MultisiteShop &shop, TaskPool &pool) {
   unsigned listId = 0;
   unsigned num_of_shops = shop.NumOfShops();
   vector<unsigned> outsourceableListId(num_of_shops, (unsigned)-1);
   vector<unsigned> nonOutsourceableListId(num_of_shops, (unsigned)-1);
   set<string> filenames;
-  unsigned minJobId = 0;
   for(vector<JobFile>::iterator it = model_.jobfiles.begin();
       it != model_.jobfiles.end();
       ++it, ++listId) {
@@ -145,15 +162,39 @@ void MultisiteJobList::CompileDefinition(const MultisiteShop &shop) {
     if(filenames.find(it->filename) != filenames.end()) {
       throw RuntimeException("Duplicate job list file name: \"" + it->filename + '\"');
     }
-    JobList list(it->filename.c_str(), shop.GetShop(shop_id).GetInfo(), minJobId);
-    minJobId += list.size();
     filenames.insert(it->filename);
-    lists_.push_back(list);
     if(list_ids_.find(it->listname) != list_ids_.end()) {
       throw RuntimeException("Duplicate job list name: \"" + GetListName(listId) + '\"');
     }
     list_ids_[it->listname] = listId;
   }
+  //the files are parsed independently of each other; the ids of the jobs
+  //of a list follow those of the lists before it, whose sizes are known
+  //only then
+  vector<TaskPool::Task> tasks;
+  lists_.resize(model_.jobfiles.size());
+  for(listId = 0; listId < lists_.size(); ++listId) {
+    JobList *list = &lists_[listId];
+    const char *filename = model_.jobfiles[listId].filename.c_str();
+    tasks.push_back([list, filename] { list->ParseFile(filename); });
+  }
+  pool.Run(tasks);
+  tasks.clear();
+  unsigned minJobId = 0;
+  for(listId = 0; listId < lists_.size(); ++listId) {
+    JobList &list = lists_[listId];
+    const ShopInfo &shopInfo = shop.GetShop(home_shop_ids_[listId]).GetInfo();
+    size_t size = list.size();
+    list.SetMinJobId(minJobId);
+    minJobId += (unsigned)size;
+    for(size_t first = 0; first < size; first += kJobsPerTask) {
+      size_t last = min(first + kJobsPerTask, size);
+      tasks.push_back([&list, &shopInfo, first, last] {
+        list.CompileJobs(shopInfo, first, last);
+      });
+    }
+  }
+  pool.Run(tasks);
 }
 
 int MultisiteJobList::NumOfLists(void) const {
@@ -215,10 +256,11 @@ void MultisiteJobList::ShopJobPointers(vector<ShopJob *> &shop_job_pointers) {
   }
 }
 
-MultisiteJobList::MultisiteJobList(const char *filename, const MultisiteShop &shop) {
+MultisiteJobList::MultisiteJobList(const char *filename, const MultisiteShop &shop,
+                                   TaskPool &pool) {
   MultisiteJobsParser parser(model_);
   parser.ParseFile(filename);
-  CompileDefinition(shop);
+  CompileDefinition(shop, pool);
   CompileOutsourceableJobs(shop);
 }
 
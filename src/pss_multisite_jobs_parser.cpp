@@ -5,7 +5,6 @@
  *
  *  implementation file for pss multi-site jobs parser
  */
-#include <fstream>
 #include "pss_multisite_jobs_parser.hpp"
 
 using namespace std;
@@ -22,14 +21,10 @@ void ParseJobsFile(xml_node<> *node, JobFile &jobsfile) {
 }
 
 int MultisiteJobsParser::ParseFile(char const *path) {
-  ifstream file(path);
-  //read the entire file into buf
-  std::vector<char> buf((istreambuf_iterator<char>(file)),
-                        istreambuf_iterator<char>());
-  buf.push_back('\0');
+  model_.source.reset(new MappedFile(path));
   xml_document<> doc;
-  //Parse the string pointed to by 'buf'
-  doc.parse<0>(&buf[0]);
+  //Parse the mapped file in place
+  ParseXmlFile(doc, *model_.source);
   //Obtain the jobs node
   xml_node<> *jobsnode = doc.first_node("MultiSiteJobList");
   ParseBaseInfo(jobsnode, model_.baseinfo);
@@ -33,12 +33,13 @@ void MultisiteScheduler::ScheduleNonOutsourceableJobs(MultisiteScheduleContext &
   assert(listId >= 0);
   assert(!job_list_.IsOutsourceableList(listId));
   unsigned homeshop_id = job_list_.GetHomeShopId(listId);
-  clock_t start = clock();
+  double cpu = ThreadCpuSeconds(), wall = WallSeconds();
   DoSchedule(scheds_[homeshop_id], job_list_.lists_[listId].jobs_,
              shop_.GetShop(homeshop_id).GetInfo(),
              msc.mach2tintvl[homeshop_id], msc.opr2tintvl[homeshop_id],
              msc.allShopJobPointers);
-  stats_[homeshop_id].cpu_sec += (clock() - start) / (double)CLOCKS_PER_SEC;
+  stats_[homeshop_id].cpu_sec += ThreadCpuSeconds() - cpu;
+  stats_[homeshop_id].wall_sec += WallSeconds() - wall;
   for(vector<pss::ShopJob>::iterator it = job_list_.lists_[listId].jobs_.begin();
       it != job_list_.lists_[listId].jobs_.end();
       ++it) {
@@ -51,22 +52,41 @@ void MultisiteScheduler::ScheduleNonOutsourceableJobs(MultisiteScheduleContext &
   }
 }
 
+void MultisiteScheduler::ScheduleCandidate(CandidateShop &candidate,
+                                           const unsigned homeshop_id,
+                                           vector<Rsrc2Tintvl> &mach2tintvl,
+                                           vector<Rsrc2Tintvl> &opr2tintvl,
+                                           const vector<ShopJob *> &allShopJobPointers) {
+  unsigned shop_id = candidate.shop_id;
+  double cpu = ThreadCpuSeconds(), wall = WallSeconds();
+  ScheduleJob(candidate.sched, candidate.shopJob,
+              (unsigned)scheds_[shop_id].size() + 1,
+              mach2tintvl[shop_id], opr2tintvl[shop_id],
+              shop_.GetShop(shop_id).GetInfo(), allShopJobPointers);
+  stats_[shop_id].cpu_sec += ThreadCpuSeconds() - cpu;
+  stats_[shop_id].wall_sec += WallSeconds() - wall;
+  if(shop_id != homeshop_id)
+    candidate.shopJob->completed += shop_.GetDelay(shop_id, homeshop_id);
+}
+
 MultisiteScheduler::MultisiteScheduler(const char *ms_shop_filename,
                                        const char *ms_job_filename,
                                        const char *ms_sched_filename,
-                                       const char *ms_jls_filename) :
-  shop_(ms_shop_filename), job_list_(ms_job_filename, shop_),
+                                       const char *ms_jls_filename,
+                                       unsigned num_threads) :
+  pool_(num_threads),
+  shop_(ms_shop_filename, pool_), job_list_(ms_job_filename, shop_, pool_),
   scheds_(shop_.NumOfShops()),
   raw_jobs_(shop_.NumOfShops()), shop_jobs_(shop_.NumOfShops()),
   stats_(shop_.NumOfShops() + 1), output_jls_files_(ms_jls_filename != NULL) {
   FilenamePrefixSuffix(ms_sched_filename, sched_filename_prefix_,
                        sched_filename_suffix_);
   FilenamePrefixSuffix(ms_jls_filename, jls_filename_prefix_, jls_filename_suffix_);
-  InitSeqPolicyDict(seqpolicydict_);
   for(vector<pss::SchedStats>::iterator itr = stats_.begin();
       itr != stats_.end();
       ++itr) {
     itr->cpu_sec = 0.0;
+    itr->wall_sec = 0.0;
     itr->outsourced_jobs = 0;
     itr->outsourced_jobs_by_shop.resize(shop_.NumOfShops());
     itr->external_jobs = 0;
@@ -87,29 +107,22 @@ void MultisiteScheduler::ConstrainOutsourceDBforGroupJob(map<unsigned,
     const vector<Rsrc2Tintvl> &mach2tintvl,
     const vector<Rsrc2Tintvl> &opr2tintvl,
     const vector<ShopJob *> &allShopJobPointers) {
-  vector<Rsrc2Tintvl> m2tvl, o2tvl;
   map<string, set<unsigned> >::const_iterator g2sItr, g2jItr;
   set<unsigned>::const_iterator shopItr, jobItr;
   time_t miniMaxCompletionTime = numeric_limits<time_t>::max();
   unsigned bestShopId = numeric_limits<unsigned>::max();
-  clock_t start;
 
   assert(!shopJob->group.empty());
   g2sItr = group2shop_ids_.find(shopJob->group);
   assert(g2sItr != group2shop_ids_.end());
   g2jItr = group2job_ids_.find(shopJob->group);
   assert(g2jItr != group2job_ids_.end());
+  vector<GroupTrial> trials;
   for(shopItr = g2sItr->second.begin();
       shopItr != g2sItr->second.end();
       ++shopItr) {
-    unsigned shop_id;
-    Sched sched;
-    time_t maxCompletionTime;
-
-    m2tvl = mach2tintvl;
-    o2tvl = opr2tintvl;
-    maxCompletionTime = numeric_limits<time_t>::min();
-    shop_id = *shopItr;
+    trials.push_back(GroupTrial());
+    trials.back().shop_id = *shopItr;
     for(jobItr = g2jItr->second.begin();
         jobItr != g2jItr->second.end();
         ++jobItr) {
@@ -117,22 +130,26 @@ void MultisiteScheduler::ConstrainOutsourceDBforGroupJob(map<unsigned,
       oj = outsource_db_.find(*jobItr);
       assert(oj != outsource_db_.end());
       map<unsigned, ShopJob>::iterator s2jItr;
-      start = clock();
-      s2jItr = oj->second.find(shop_id);
+      s2jItr = oj->second.find(*shopItr);
       assert(s2jItr != oj->second.end());
-      ScheduleJob(sched, &s2jItr->second, 0 /* priority */,
-                  m2tvl[shop_id], o2tvl[shop_id],
-                  shop_.GetShop(shop_id).GetInfo(), allShopJobPointers);
-      CommitSchedule(sched, m2tvl[shop_id], o2tvl[shop_id]);
-      stats_[shop_id].cpu_sec += (clock() - start) / (double)CLOCKS_PER_SEC;
-      s2jItr->second.completed += shop_.GetDelay(shop_id, homeshop_id);
-      if(s2jItr->second.completed > maxCompletionTime) {
-        maxCompletionTime = s2jItr->second.completed;
-      }
+      job_list_.TranslateOutsourcedJob(s2jItr->second, *jobItr, *shopItr, shop_);
     }
-    if(miniMaxCompletionTime > maxCompletionTime) {
-      miniMaxCompletionTime = maxCompletionTime;
-      bestShopId = shop_id;
+  }
+  vector<TaskPool::Task> tasks;
+  for(size_t t = 0; t < trials.size(); ++t) {
+    unsigned shop_id = trials[t].shop_id;
+    tasks.push_back(boost::bind(&MultisiteScheduler::ScheduleGroupTrial, this,
+                                boost::ref(trials[t]), boost::ref(outsource_db_),
+                                boost::ref(stats_), boost::cref(g2jItr->second),
+                                homeshop_id, boost::cref(mach2tintvl[shop_id]),
+                                boost::cref(opr2tintvl[shop_id]),
+                                boost::cref(allShopJobPointers)));
+  }
+  pool_.Run(tasks);
+  for(size_t t = 0; t < trials.size(); ++t) {
+    if(miniMaxCompletionTime > trials[t].maxCompletionTime) {
+      miniMaxCompletionTime = trials[t].maxCompletionTime;
+      bestShopId = trials[t].shop_id;
     }
   }
   assert(bestShopId != numeric_limits<unsigned>::max());
@@ -152,23 +169,146 @@ void MultisiteScheduler::ConstrainOutsourceDBforGroupJob(map<unsigned,
   }
 }
 
+void MultisiteScheduler::ScheduleGroupTrial(GroupTrial &trial,
+    map<unsigned, map<unsigned, pss::ShopJob> > &outsourceDB,
+    vector<pss::SchedStats> &stats,
+    const set<unsigned> &jobIds, const unsigned homeshop_id,
+    const Rsrc2Tintvl &mach2tintvl, const Rsrc2Tintvl &opr2tintvl,
+    const vector<ShopJob *> &allShopJobPointers) {
+  unsigned shop_id = trial.shop_id;
+  const ShopInfo &shopInfo = shop_.GetShop(shop_id).GetInfo();
+  double cpu = ThreadCpuSeconds(), wall = WallSeconds();
+  Rsrc2Tintvl m2tvl(mach2tintvl), o2tvl(opr2tintvl);
+  Sched sched;
+
+  trial.maxCompletionTime = numeric_limits<time_t>::min();
+  for(set<unsigned>::const_iterator jobItr = jobIds.begin();
+      jobItr != jobIds.end();
+      ++jobItr) {
+    ShopJob &shopJob = outsourceDB.find(*jobItr)->second.find(shop_id)->second;
+    ScheduleJob(sched, &shopJob, 0 /* priority */, m2tvl, o2tvl, shopInfo,
+                allShopJobPointers);
+    CommitSchedule(sched, m2tvl, o2tvl);
+    shopJob.completed += shop_.GetDelay(shop_id, homeshop_id);
+    if(shopJob.completed > trial.maxCompletionTime) {
+      trial.maxCompletionTime = shopJob.completed;
+    }
+  }
+  stats[shop_id].cpu_sec += ThreadCpuSeconds() - cpu;
+  stats[shop_id].wall_sec += WallSeconds() - wall;
+}
+
+void MultisiteScheduler::PrepareDecision(OutsourceDecision &decision,
+                                         const vector<Rsrc2Tintvl> &mach2tintvl,
+                                         const vector<Rsrc2Tintvl> &opr2tintvl,
+                                         const vector<ShopJob *> &allShopJobPointers) {
+  OutsourceableList &ol = *decision.list;
+  ShopJob *sj = ol.jobs[ol.next];
+  unsigned job_int_id = sj->intid;
+  //the home shop comes first, followed by the other shops in the
+  //order of their ids
+  decision.candidates.resize(1);
+  decision.candidates[0].shop_id = ol.homeshop_id;
+  decision.candidates[0].shopJob = sj;
+  map<unsigned, map<unsigned, ShopJob> >::iterator oj;
+  oj = job_list_.outsource_db_.find(job_int_id);
+  if(oj != job_list_.outsource_db_.end()) {
+    assert(oj->second.size() > 0);
+    //> 1 shop_ candidate for job group
+    if(!sj->group.empty() && oj->second.size() > 1) {
+      ConstrainOutsourceDBforGroupJob(job_list_.outsource_db_, stats_,
+                                      sj, ol.homeshop_id,
+                                      job_list_.group2shop_ids_, job_list_.group2job_ids_,
+                                      mach2tintvl, opr2tintvl,
+                                      allShopJobPointers);
+      assert(oj == job_list_.outsource_db_.find(job_int_id));
+      assert(oj->second.size() == 1);
+    }
+    map<unsigned, ShopJob>::iterator s2j;
+    for(s2j = oj->second.begin(); s2j != oj->second.end(); ++s2j) {
+      job_list_.TranslateOutsourcedJob(s2j->second, job_int_id, s2j->first, shop_);
+      decision.candidates.push_back(CandidateShop());
+      decision.candidates.back().shop_id = s2j->first;
+      decision.candidates.back().shopJob = &s2j->second;
+    }
+  }
+  vector<CandidateShop> &candidates = decision.candidates;
+  decision.order.clear();
+  for(size_t c = 0; c < candidates.size(); ++c) {
+    candidates[c].scheduled = false;
+    candidates[c].bound = 0;
+    if(candidates.size() > 1) {
+      unsigned shop_id = candidates[c].shop_id;
+      candidates[c].bound = CompletionLowerBound(candidates[c].shopJob,
+                                                 shop_.GetShop(shop_id).GetInfo());
+      if(shop_id != ol.homeshop_id)
+        candidates[c].bound += shop_.GetDelay(shop_id, ol.homeshop_id);
+    }
+    size_t k = decision.order.size();
+    decision.order.push_back(c);
+    for(; k > 0 && candidates[decision.order[k - 1]].bound > candidates[c].bound; --k)
+      decision.order[k] = decision.order[k - 1];
+    decision.order[k] = c;
+  }
+}
+
+void MultisiteScheduler::CommitDecision(OutsourceDecision &decision,
+                                        vector<Rsrc2Tintvl> &mach2tintvl,
+                                        vector<Rsrc2Tintvl> &opr2tintvl) {
+  OutsourceableList &ol = *decision.list;
+  vector<CandidateShop> &candidates = decision.candidates;
+  unsigned homeshop_id = ol.homeshop_id;
+  //the first of the candidates that complete the job earliest wins; the
+  //ones not scheduled could not have
+  size_t best = decision.order[0];
+  for(size_t c = 0; c < candidates.size(); ++c) {
+    if(candidates[c].scheduled &&
+       (candidates[c].shopJob->completed < candidates[best].shopJob->completed ||
+        (candidates[c].shopJob->completed == candidates[best].shopJob->completed &&
+         c < best)))
+      best = c;
+  }
+  unsigned bestShopId = candidates[best].shop_id;
+  ShopJob *bestShopJob = candidates[best].shopJob;
+  Job *rawJob = &(*ol.rawJobs)[bestShopJob->intid - ol.firstShopJobIntId];
+  CommitSchedule(candidates[best].sched, mach2tintvl[bestShopId],
+                 opr2tintvl[bestShopId]);
+  scheds_[bestShopId][bestShopJob->intid].swap(candidates[best].sched);
+  raw_jobs_[bestShopId].push_back(rawJob);
+  shop_jobs_[bestShopId].push_back(bestShopJob);
+  if(bestShopId != homeshop_id) {
+    ++stats_[homeshop_id].outsourced_jobs;
+    ++stats_[homeshop_id].outsourced_jobs_by_shop[bestShopId];
+    ++stats_[bestShopId].external_jobs;
+    ++stats_[bestShopId].external_jobs_by_shop[homeshop_id];
+  }
+  assert(scheds_[bestShopId].size() == bestShopJob->priority);
+  const vector<unsigned> &shopIds = ol.shopIds[ol.next];
+  for(vector<unsigned>::const_iterator s = shopIds.begin(); s != shopIds.end(); ++s)
+    --ol.pending[*s];
+  const string &group = ol.jobs[ol.next]->group;
+  if(!group.empty())
+    --ol.pendingGroups[group];
+  ++ol.next;
+}
+
 void MultisiteScheduler::Run(void) {
   clock_t startTime = clock();
+  double startWall = WallSeconds();
   unsigned numOfLists = job_list_.NumOfLists();
   unsigned num_of_shops = shop_.NumOfShops();
-  //list of shops that can process all jobs in a group
-  map<string, set<unsigned> > &group2shop_ids_ = job_list_.group2shop_ids_;
-  //list of job ids belong to the same group
-  map<string, set<unsigned> > &group2job_ids_ = job_list_.group2job_ids_;
   vector<Rsrc2Tintvl> mach2tintvl(num_of_shops);
   vector<Rsrc2Tintvl> opr2tintvl(num_of_shops);
   vector<ShopJob *> allShopJobPointers;
   job_list_.ShopJobPointers(allShopJobPointers);
+  time_t from = numeric_limits<time_t>::max(), to = numeric_limits<time_t>::min();
+  for(unsigned listId = 0; listId < numOfLists; ++listId)
+    JobsHorizon(job_list_.lists_[listId].jobs_, from, to);
+  shop_.PrepareCalendars(from, to);
   MultisiteScheduleContext msc(-1, mach2tintvl, opr2tintvl, allShopJobPointers);
-#ifdef PSS_MULTI_THREADING
-  vector<boost::thread *> schedThreads(numOfLists);
-  vector<MultisiteScheduleContext> mscThreads(numOfLists, msc);
-#endif
+  //a shop has at most one non-outsourceable list s.t. the lists are
+  //scheduled independently of each other
+  vector<TaskPool::Task> listTasks;
   for(unsigned listId = 0; listId < numOfLists; ++listId) {
     if(!job_list_.IsOutsourceableList(listId)) {
       /*
@@ -189,109 +329,124 @@ void MultisiteScheduler::Run(void) {
       raw_jobs_[homeshop_id].push_back(&(*it));
       } */
       msc.listId = listId;
-#ifdef PSS_MULTI_THREADING
-      mscThreads[listId].listId = listId;
-      schedThreads[listId] =
-        new boost::thread(boost::bind(&MultisiteScheduler::ScheduleNonOutsourceableJobs,
-                                      this, mscThreads[listId]));
-#else
-      ScheduleNonOutsourceableJobs(msc);
-#endif //PSS_MULTI_THREADING
+      listTasks.push_back(boost::bind(&MultisiteScheduler::ScheduleNonOutsourceableJobs,
+                                      this, msc));
     }
   }
+  pool_.Run(listTasks);
 
-#ifdef PSS_MULTI_THREADING
-  for(unsigned listId = 0; listId < numOfLists; ++listId) {
-    if(!job_list_.IsOutsourceableList(listId))
-      schedThreads[listId]->join();
-  }
-
-  for(unsigned listId = 0; listId < numOfLists; ++listId) {
-    if(!job_list_.IsOutsourceableList(listId))
-      delete schedThreads[listId];
-  }
-#endif //PSS_MULTI_THREADING
-
+  vector<OutsourceableList> olists;
   for(unsigned listId = 0; listId < numOfLists; ++listId) {
     if(job_list_.IsOutsourceableList(listId)) {
-      unsigned homeshop_id = job_list_.GetHomeShopId(listId);
-      const ShopInfo &homeshopInfo = shop_.GetShop(homeshop_id).GetInfo();
+      olists.push_back(OutsourceableList());
+      OutsourceableList &ol = olists.back();
+      ol.homeshop_id = job_list_.GetHomeShopId(listId);
+      const ShopInfo &homeshopInfo = shop_.GetShop(ol.homeshop_id).GetInfo();
       vector<ShopJob> &jobs(job_list_.lists_[listId].jobs_);
-      vector<Job> &list(job_list_.lists_[listId].model_.jobs);
-      vector<Job>::iterator rj;
-      //vector<shop_job_t>::iterator sj;
-      unsigned firstShopJobIntId = jobs[0].intid;
+      ol.rawJobs = &job_list_.lists_[listId].model_.jobs;
+      ol.firstShopJobIntId = jobs[0].intid;
       //quick and dirty check of whether the "intid" field
       //is consecutively numbered
-      assert(jobs[jobs.size() - 1].intid == firstShopJobIntId + jobs.size() - 1);
-      vector<ShopJob *> shop_job_ptrs;
-      ShopJobPointers(shop_job_ptrs, jobs);
-      sort(shop_job_ptrs.begin(), shop_job_ptrs.end(),
-           seqpolicydict_[homeshopInfo.config.sequencepolicy]);
-      for(vector<ShopJob *>::iterator jp = shop_job_ptrs.begin();
-          jp != shop_job_ptrs.end();
-          ++jp) {
-        //for (rj = list.begin(), sj = jobs.begin();
-        //rj != list.end() && sj != jobs.end(); ++rj, ++sj) {
-        ShopJob *sj = *jp;
-        unsigned job_int_id = sj->intid;
-        Sched sched, bestSched;
-        unsigned bestShopId = homeshop_id;
-        clock_t start = clock();
-        ScheduleJob(bestSched, &*sj, (unsigned)scheds_[homeshop_id].size() + 1,
-                    mach2tintvl[homeshop_id], opr2tintvl[homeshop_id],
-                    homeshopInfo, allShopJobPointers);
-        stats_[homeshop_id].cpu_sec += (clock() - start) / (double)CLOCKS_PER_SEC;
-        time_t minCompletionTime = sj->completed;
-        //job_t *rawJob = &(*rj);
-        Job *rawJob = &list[sj->intid - firstShopJobIntId];
-        ShopJob *bestShopJob = &(*sj);
+      assert(jobs[jobs.size() - 1].intid == ol.firstShopJobIntId + jobs.size() - 1);
+      ShopJobPointers(ol.jobs, jobs);
+      SortShopJobs(ol.jobs, homeshopInfo.config.sequencepolicy);
+      ol.pending.assign(num_of_shops, 0);
+      ol.next = 0;
+      for(vector<ShopJob *>::iterator jp = ol.jobs.begin(); jp != ol.jobs.end(); ++jp) {
+        ol.shopIds.push_back(vector<unsigned>(1, ol.homeshop_id));
         map<unsigned, map<unsigned, ShopJob> >::iterator oj;
-        oj = job_list_.outsource_db_.find(job_int_id);
+        oj = job_list_.outsource_db_.find((*jp)->intid);
         if(oj != job_list_.outsource_db_.end()) {
-          assert(oj->second.size() > 0);
-          //> 1 shop_ candidate for job group
-          if(!sj->group.empty() && oj->second.size() > 1) {
-            ConstrainOutsourceDBforGroupJob(job_list_.outsource_db_, stats_,
-                                            sj, homeshop_id,
-                                            group2shop_ids_, group2job_ids_,
-                                            mach2tintvl, opr2tintvl,
-                                            allShopJobPointers);
-            assert(oj == job_list_.outsource_db_.find(job_int_id));
-            assert(oj->second.size() == 1);
-          }
           map<unsigned, ShopJob>::iterator s2j;
-          for(s2j = oj->second.begin(); s2j != oj->second.end(); ++s2j) {
-            unsigned shop_id = s2j->first;
-            start = clock();
-            ScheduleJob(sched, &s2j->second, (unsigned)scheds_[shop_id].size() + 1,
-                        mach2tintvl[shop_id], opr2tintvl[shop_id],
-                        shop_.GetShop(shop_id).GetInfo(), allShopJobPointers);
-            stats_[shop_id].cpu_sec += (clock() - start) / (double)CLOCKS_PER_SEC;
-            s2j->second.completed += shop_.GetDelay(shop_id, homeshop_id);
-            if(s2j->second.completed < minCompletionTime) {
-              bestSched = sched;
-              minCompletionTime = s2j->second.completed;
-              bestShopId = shop_id;
-              bestShopJob = &s2j->second;
-            }
-          }
+          for(s2j = oj->second.begin(); s2j != oj->second.end(); ++s2j)
+            ol.shopIds.back().push_back(s2j->first);
         }
-        CommitSchedule(bestSched, mach2tintvl[bestShopId], opr2tintvl[bestShopId]);
-        scheds_[bestShopId][bestShopJob->intid] = bestSched;
-        raw_jobs_[bestShopId].push_back(rawJob);
-        shop_jobs_[bestShopId].push_back(bestShopJob);
-        if(bestShopId != homeshop_id) {
-          ++stats_[homeshop_id].outsourced_jobs;
-          ++stats_[homeshop_id].outsourced_jobs_by_shop[bestShopId];
-          ++stats_[bestShopId].external_jobs;
-          ++stats_[bestShopId].external_jobs_by_shop[homeshop_id];
+        for(vector<unsigned>::iterator s = ol.shopIds.back().begin();
+            s != ol.shopIds.back().end();
+            ++s)
+          ++ol.pending[*s];
+        if(!(*jp)->group.empty())
+          ++ol.pendingGroups[(*jp)->group];
+      }
+    }
+  }
+  //outsourceable lists are decided one after another, job by job; the next
+  //job of a list is decided ahead of its turn if none of the undecided jobs
+  //of earlier lists may read its shops, s.t. every shop sees the same
+  //commits in the same order as without deciding ahead. A job of a group
+  //also waits for the undecided jobs of its group in earlier lists, as the
+  //first of them decides for the whole group (see
+  //ConstrainOutsourceDBforGroupJob())
+  for(;;) {
+    vector<OutsourceDecision> decisions;
+    vector<unsigned> earlier(num_of_shops, 0); //undecided jobs of earlier lists
+    vector<OutsourceableList *> earlierLists;
+    for(vector<OutsourceableList>::iterator ol = olists.begin(); ol != olists.end(); ++ol) {
+      if(ol->next == ol->jobs.size())
+        continue;
+      const vector<unsigned> &shopIds = ol->shopIds[ol->next];
+      const string &group = ol->jobs[ol->next]->group;
+      bool ready = true;
+      for(vector<unsigned>::const_iterator s = shopIds.begin(); s != shopIds.end(); ++s) {
+        if(earlier[*s] > 0)
+          ready = false;
+      }
+      if(!group.empty()) {
+        for(vector<OutsourceableList *>::iterator el = earlierLists.begin();
+            el != earlierLists.end();
+            ++el) {
+          map<string, unsigned>::const_iterator g = (*el)->pendingGroups.find(group);
+          if(g != (*el)->pendingGroups.end() && g->second > 0)
+            ready = false;
         }
-        assert(scheds_[bestShopId].size() == bestShopJob->priority);
       }
+      if(ready) {
+        decisions.push_back(OutsourceDecision());
+        decisions.back().list = &*ol;
+      }
+      for(unsigned shop_id = 0; shop_id < num_of_shops; ++shop_id)
+        earlier[shop_id] += ol->pending[shop_id];
+      earlierLists.push_back(&*ol);
+    }
+    if(decisions.empty())
+      break;
+    //the candidate of each decision with the lowest bound is scheduled
+    //first, then the others whose bound does not rule them out
+    vector<TaskPool::Task> tasks;
+    vector<OutsourceDecision>::iterator d;
+    for(d = decisions.begin(); d != decisions.end(); ++d) {
+      PrepareDecision(*d, mach2tintvl, opr2tintvl, allShopJobPointers);
+      CandidateShop &first = d->candidates[d->order[0]];
+      first.scheduled = true;
+      tasks.push_back(boost::bind(&MultisiteScheduler::ScheduleCandidate, this,
+                                  boost::ref(first), d->list->homeshop_id,
+                                  boost::ref(mach2tintvl), boost::ref(opr2tintvl),
+                                  boost::cref(allShopJobPointers)));
     }
+    pool_.Run(tasks);
+    tasks.clear();
+    for(d = decisions.begin(); d != decisions.end(); ++d) {
+      time_t firstCompleted = d->candidates[d->order[0]].shopJob->completed;
+      for(size_t k = 1; k < d->order.size(); ++k) {
+        size_t c = d->order[k];
+        CandidateShop &candidate = d->candidates[c];
+        //cannot complete the job earlier, or only as early but loses the tie
+        if(candidate.bound > firstCompleted ||
+           (candidate.bound == firstCompleted && c > d->order[0]))
+          continue;
+        candidate.scheduled = true;
+        tasks.push_back(boost::bind(&MultisiteScheduler::ScheduleCandidate, this,
+                                    boost::ref(candidate), d->list->homeshop_id,
+                                    boost::ref(mach2tintvl), boost::ref(opr2tintvl),
+                                    boost::cref(allShopJobPointers)));
+      }
+    }
+    pool_.Run(tasks);
+    for(d = decisions.begin(); d != decisions.end(); ++d)
+      CommitDecision(*d, mach2tintvl, opr2tintvl);
   }
   stats_[num_of_shops].cpu_sec = (clock() - startTime) / (double)CLOCKS_PER_SEC;
+  stats_[num_of_shops].wall_sec = WallSeconds() - startWall;
   for(unsigned shop_id = 0; shop_id < num_of_shops; ++shop_id) {
     const ShopInfo &shopInfo = shop_.GetShop(shop_id).GetInfo();
     ofstream sched_file;
@@ -325,9 +480,17 @@ void MultisiteScheduler::PrintInfo(ostream &os) {
     os << endl;
   }
   os << "Total CPU seconds = " << stats_[num_of_shops].cpu_sec << endl;
-#ifdef PSS_MULTI_THREADING
-  os << "Multi-threading = ON" << endl;
-#endif
+  os << "Total wall seconds = " << stats_[num_of_shops].wall_sec << endl;
+  os << "Threads = " << pool_.NumThreads() << endl;
+  //share of the threads' time spent scheduling some shop
+  double busy_sec = 0.0;
+  for(unsigned shop_id = 0; shop_id < num_of_shops; ++shop_id)
+    busy_sec += stats_[shop_id].cpu_sec;
+  if(stats_[num_of_shops].wall_sec > 0.0) {
+    os << "Thread utilization = "
+       << 100.0 * busy_sec / (stats_[num_of_shops].wall_sec * pool_.NumThreads())
+       << '%' << endl;
+  }
 }
 
 } // namespace pss
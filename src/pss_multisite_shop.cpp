@@ -33,6 +33,11 @@ const Shop &MultisiteShop::GetShop(unsigned shop_id) const {
   return shops_[shop_id];
 }
 
+void MultisiteShop::PrepareCalendars(time_t from, time_t to) {
+  for(vector<Shop>::iterator it = shops_.begin(); it != shops_.end(); ++it)
+    it->PrepareCalendars(from, to);
+}
+
 int MultisiteShop::NumOfShops(void) const {
   return (int)shops_.size();
 }
@@ -54,15 +59,20 @@ void MultisiteShop::ValidateDelayMatrix(void) const {
   }
 }
 
-void MultisiteShop::CompileDefinition(void) {
+void MultisiteShop::CompileDefinition(TaskPool &pool) {
   unsigned shop_id = 0;
+  //the shops are parsed and compiled independently of each other
+  vector<TaskPool::Task> tasks;
+  shops_.resize(model_.shopfiles.size());
   for(vector<ShopFile>::iterator it = model_.shopfiles.begin();
       it != model_.shopfiles.end();
       ++it, ++shop_id) {
-    Shop shop(it->filename);
-    shops_.push_back(shop);
+    Shop *shop = &shops_[shop_id];
+    const string &filename = it->filename;
+    tasks.push_back([shop, &filename] { shop->Load(filename); });
     shop_ids_[it->shopname] = shop_id;
   }
+  pool.Run(tasks);
   int num_of_shops = (int)model_.shopfiles.size();
   delay_matrix_.resize(num_of_shops * num_of_shops);
   fill(delay_matrix_.begin(), delay_matrix_.end(), 0);
@@ -76,12 +86,69 @@ void MultisiteShop::CompileDefinition(void) {
     }
   }
   ValidateDelayMatrix();
+  CompileCapabilities();
+}
+
+void MultisiteShop::CompileCapabilities(void) {
+  unsigned num_of_bits = 0;
+  for(vector<Shop>::const_iterator it = shops_.begin(); it != shops_.end(); ++it) {
+    const ShopInfo &shopInfo = it->GetInfo();
+    for(One2Many::const_iterator f = shopInfo.func2sameseqfunc.begin();
+        f != shopInfo.func2sameseqfunc.end();
+        ++f) {
+      if(func_bits_.find(f->first) == func_bits_.end())
+        func_bits_[f->first] = num_of_bits++;
+    }
+    for(map<string, double>::const_iterator r = shopInfo.rsrc2speed.begin();
+        r != shopInfo.rsrc2speed.end();
+        ++r) {
+      if(unit_bits_.find(r->first) == unit_bits_.end())
+        unit_bits_[r->first] = num_of_bits++;
+    }
+  }
+  capabilities_.assign(shops_.size(), boost::dynamic_bitset<>(num_of_bits));
+  for(unsigned shop_id = 0; shop_id < shops_.size(); ++shop_id) {
+    const ShopInfo &shopInfo = shops_[shop_id].GetInfo();
+    for(One2Many::const_iterator f = shopInfo.func2sameseqfunc.begin();
+        f != shopInfo.func2sameseqfunc.end();
+        ++f)
+      capabilities_[shop_id].set(func_bits_[f->first]);
+    for(map<string, double>::const_iterator r = shopInfo.rsrc2speed.begin();
+        r != shopInfo.rsrc2speed.end();
+        ++r)
+      capabilities_[shop_id].set(unit_bits_[r->first]);
+  }
+}
+
+bool MultisiteShop::RequiredCapabilities(const Job &job,
+                                         boost::dynamic_bitset<> &required) const {
+  map<string, unsigned>::const_iterator b;
+  required.resize(func_bits_.size() + unit_bits_.size());
+  required.reset();
+  for(vector<Step>::const_iterator s = job.steps.begin(); s != job.steps.end(); ++s) {
+    if((b = func_bits_.find(s->stepinfo.function)) == func_bits_.end())
+      return false;
+    required.set(b->second);
+  }
+  for(vector<Resource>::const_iterator r = job.resources.begin();
+      r != job.resources.end();
+      ++r) {
+    if((b = unit_bits_.find(r->quantity.unit)) == unit_bits_.end())
+      return false;
+    required.set(b->second);
+  }
+  return true;
+}
+
+bool MultisiteShop::IsCapable(unsigned shop_id,
+                              const boost::dynamic_bitset<> &required) const {
+  return required.is_subset_of(capabilities_[shop_id]);
 }
 
-MultisiteShop::MultisiteShop(const char *filename) {
+MultisiteShop::MultisiteShop(const char *filename, TaskPool &pool) {
   MultisiteShopParser parser(model_);
   parser.ParseFile(filename);
-  CompileDefinition();
+  CompileDefinition(pool);
 }
 
 time_t MultisiteShop::GetDelay(unsigned src_shop_id, unsigned dest_shop_id) const {
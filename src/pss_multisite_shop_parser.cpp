@@ -5,7 +5,6 @@
  *
  *  implementation file pss multi-site shop parser
  */
-#include <fstream>
 #include "pss_multisite_shop_parser.hpp"
 
 using namespace std;
@@ -30,14 +29,10 @@ void ParseShop(xml_node<> *node, ShopFile &shopfile) {
 }
 
 int MultisiteShopParser::ParseFile(char const *path) {
-  ifstream file(path);
-  //read the entire file into buf
-  std::vector<char> buf((istreambuf_iterator<char>(file)),
-                        istreambuf_iterator<char>());
-  buf.push_back('\0');
+  model_.source.reset(new MappedFile(path));
   xml_document<> doc;
-  //Parse the string pointed to by 'buf'
-  doc.parse<0>(&buf[0]);
+  //Parse the mapped file in place
+  ParseXmlFile(doc, *model_.source);
   //Obtain the multi-site shop node
   xml_node<> *shpnode = doc.first_node("MultiSiteShop");
   ParseBaseInfo(shpnode, model_.baseinfo);
@@ -1,3 +1,7 @@
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
 #include <boost/algorithm/string.hpp>
 #include "pss_parser_utils.hpp"
 
@@ -6,18 +10,192 @@ using namespace rapidxml;
 
 namespace pss {
 
+void ParseXmlFile(xml_document<> &doc, const MappedFile &source) {
+  //the text is left as it is, which is what lets it be mapped read-only
+  doc.parse<parse_non_destructive>(const_cast<char *>(source.data()));
+}
+
+static const char *SkipSpace(const char *p, const char *last) {
+  while(p != last && isspace(static_cast<unsigned char>(*p)))
+    ++p;
+  return p;
+}
+
+static const char *SkipDigits(const char *p, const char *last) {
+  while(p != last && isdigit(static_cast<unsigned char>(*p)))
+    ++p;
+  return p;
+}
+
+template<typename T>
+static void ParseInteger(const char *p, const char *last, T &value) {
+  p = SkipSpace(p, last);
+  if(p == last)
+    return;
+  bool negative = false;
+  if(p != last && (*p == '+' || *p == '-'))
+    negative = *p++ == '-';
+  const T limit = negative ? numeric_limits<T>::min() : numeric_limits<T>::max();
+  const char *digits = p;
+  T v = 0;
+  for(; p != last && isdigit(static_cast<unsigned char>(*p)); ++p) {
+    T d = *p - '0';
+    //the next digit would take 'v' past 'limit'
+    if(negative ? v < (limit + d) / 10 : v > (limit - d) / 10) {
+      v = limit;
+      p = SkipDigits(p, last);
+      break;
+    }
+    v = v * 10 + (negative ? -d : d);
+  }
+  value = p == digits ? 0 : v;
+}
+
+void ParseNumber(const char *first, const char *last, int &value) {
+  ParseInteger(first, last, value);
+}
+
+void ParseNumber(const char *first, const char *last, long &value) {
+  ParseInteger(first, last, value);
+}
+
+void ParseNumber(const char *first, const char *last, long long &value) {
+  ParseInteger(first, last, value);
+}
+
+void ParseNumber(const char *first, const char *last, double &value) {
+  //the characters a stream would take for a double: strtod() alone would
+  //also read e.g. "inf" or hexadecimal, and needs a terminated string
+  const char *p = SkipSpace(first, last);
+  if(p == last)
+    return;
+  const char *start = p;
+  if(p != last && (*p == '+' || *p == '-'))
+    ++p;
+  const char *mantissa = p;
+  p = SkipDigits(p, last);
+  bool digits = p != mantissa;
+  if(p != last && *p == '.') {
+    const char *fraction = ++p;
+    p = SkipDigits(p, last);
+    digits = digits || p != fraction;
+  }
+  if(!digits) {
+    value = 0;
+    return;
+  }
+  if(p != last && (*p == 'e' || *p == 'E')) {
+    ++p;
+    if(p != last && (*p == '+' || *p == '-'))
+      ++p;
+    p = SkipDigits(p, last);
+  }
+  char buf[64];
+  string str;
+  const char *number = buf;
+  if(static_cast<size_t>(p - start) < sizeof(buf)) {
+    memcpy(buf, start, p - start);
+    buf[p - start] = '\0';
+  } else {
+    str.assign(start, p);
+    number = str.c_str();
+  }
+  char *end;
+  value = strtod(number, &end);
+  //a stream takes a dangling exponent (e.g. "1e") and then fails
+  if(*end != '\0')
+    value = 0;
+  else if(value == numeric_limits<double>::infinity())
+    value = numeric_limits<double>::max();
+  else if(value == -numeric_limits<double>::infinity())
+    value = -numeric_limits<double>::max();
+}
+
+//appends character 'code' to 'str' in UTF-8
+static void AppendUtf8(string &str, unsigned long code) {
+  if(code < 0x80) {
+    str += static_cast<char>(code);
+  } else if(code < 0x800) {
+    str += static_cast<char>(0xC0 | (code >> 6));
+    str += static_cast<char>(0x80 | (code & 0x3F));
+  } else if(code < 0x10000) {
+    str += static_cast<char>(0xE0 | (code >> 12));
+    str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    str += static_cast<char>(0x80 | (code & 0x3F));
+  } else {
+    str += static_cast<char>(0xF0 | (code >> 18));
+    str += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+    str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    str += static_cast<char>(0x80 | (code & 0x3F));
+  }
+}
+
+//sets 'str' to 'text' with the character and entity references translated
+//as rapidxml does when parsing destructively; unknown ones are kept
+static void TranslateReferences(string &str, TextView text) {
+  str.clear();
+  for(;;) {
+    const char *amp = static_cast<const char *>(memchr(text.data(), '&', text.size()));
+    const char *semicolon = NULL;
+    if(amp != NULL) {
+      semicolon = static_cast<const char *>(
+                    memchr(amp, ';', text.data() + text.size() - amp));
+    }
+    if(semicolon == NULL) {
+      str.append(text.data(), text.size());
+      return;
+    }
+    str.append(text.data(), amp);
+    TextView ref(amp + 1, semicolon - amp - 1);
+    if(ref == "lt")
+      str += '<';
+    else if(ref == "gt")
+      str += '>';
+    else if(ref == "amp")
+      str += '&';
+    else if(ref == "quot")
+      str += '"';
+    else if(ref == "apos")
+      str += '\'';
+    else if(ref.size() > 1 && ref[0] == '#') {
+      char digits[16];
+      char *end;
+      bool hex = ref[1] == 'x';
+      TextView number = ref.substr(hex ? 2 : 1);
+      unsigned long code = 0;
+      if(!number.empty() && number.size() < sizeof(digits)) {
+        memcpy(digits, number.data(), number.size());
+        digits[number.size()] = '\0';
+        code = strtoul(digits, &end, hex ? 16 : 10);
+        if(*end != '\0' || !isxdigit((unsigned char)digits[0]))
+          code = 0;
+      }
+      if(code > 0 && code <= 0x10FFFF)
+        AppendUtf8(str, code);
+      else
+        str.append(amp, semicolon + 1);
+    } else
+      str.append(amp, semicolon + 1);
+    text = TextView(semicolon + 1, text.data() + text.size() - semicolon - 1);
+  }
+}
+
 void ParseBoolAttr(xml_node<> *node, char const *name, bool &attr) {
+  xml_attribute<> *attribute = node->first_attribute(name);
   //iequals does case insensitive string comparison
-  attr = boost::iequals(node->first_attribute(name)->value(), "true");
+  attr = boost::iequals(TextView(attribute->value(), attribute->value_size()), "true");
 }
 
 void ParseStrAttr(xml_node<> *node, char const *name, string &attr) {
   xml_attribute<> *attribute = node->first_attribute(name);
   if(attribute)
-    attr = node->first_attribute(name)->value();
-  //printf("%s\n", node->first_attribute(name)->value());
-  //attr = node->first_attribute(name)->value();
-  //cout << "str = " << attr << endl;
+    TranslateReferences(attr, TextView(attribute->value(), attribute->value_size()));
+}
+
+void ParseStrAttr(xml_node<> *node, char const *name, TextView &attr) {
+  xml_attribute<> *attribute = node->first_attribute(name);
+  if(attribute)
+    attr = TextView(attribute->value(), attribute->value_size());
 }
 
 void ParseNameAttr(xml_node<> *node, string &name) {
@@ -93,7 +271,7 @@ void ParseScope(xml_node<> *node, Scope &scope) {
 }
 
 void ParseWeekSchd(xml_node<> *node, WeekSchd &weekschd) {
-  weekschd.weekday = node->first_attribute("Weekday")->value();
+  ParseStrAttr(node, "Weekday", weekschd.weekday);
   ParseScope(node, weekschd.scope);
   ParseTimeSlots(node, weekschd.timeslots);
 }
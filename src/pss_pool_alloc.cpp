@@ -0,0 +1,75 @@
+/*  pss_pool_alloc.cpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  implementation file for the node pool
+ */
+
+#include <assert.h>
+#include "pss_pool_alloc.hpp"
+
+using namespace std;
+
+namespace pss {
+
+static const size_t kMinSlabNodes = 32;
+static const size_t kMaxSlabNodes = 4096;
+
+NodePool::NodePool(void) :
+  node_size_(0), slab_nodes_(kMinSlabNodes), free_list_(NULL),
+  cur_(NULL), end_(NULL), refs_(1) {
+}
+
+NodePool::~NodePool() {
+  for(vector<char *>::iterator s = slabs_.begin(); s != slabs_.end(); ++s)
+    ::operator delete(*s);
+}
+
+//kept out of line s.t. the deletion is not inlined into (and confused with)
+//the other copies of an allocator still referring to the pool
+void NodePool::Release(NodePool *pool) {
+  if(pool->refs_.fetch_sub(1, boost::memory_order_acq_rel) == 1)
+    delete pool;
+}
+
+void NodePool::Grow(void) {
+  char *slab = static_cast<char *>(::operator new(slab_nodes_ * node_size_));
+  slabs_.push_back(slab);
+  cur_ = slab;
+  end_ = slab + slab_nodes_ * node_size_;
+  if(slab_nodes_ < kMaxSlabNodes)
+    slab_nodes_ *= 2;
+}
+
+void *NodePool::Allocate(size_t size) {
+  if(node_size_ == 0) {
+    //round up so that every node stays suitably aligned
+    node_size_ = (size + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+    if(node_size_ < sizeof(FreeNode))
+      node_size_ = sizeof(FreeNode);
+  } else if(size > node_size_)
+    return ::operator new(size);
+  if(free_list_) {
+    FreeNode *node = free_list_;
+    free_list_ = node->next;
+    return node;
+  }
+  if(cur_ == end_)
+    Grow();
+  void *p = cur_;
+  cur_ += node_size_;
+  return p;
+}
+
+void NodePool::Deallocate(void *p, size_t size) {
+  assert(node_size_ > 0);
+  if(size > node_size_) {
+    ::operator delete(p);
+    return;
+  }
+  FreeNode *node = static_cast<FreeNode *>(p);
+  node->next = free_list_;
+  free_list_ = node;
+}
+
+} // namespace pss
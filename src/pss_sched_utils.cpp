@@ -9,6 +9,8 @@
 #include <cmath>
 #include <algorithm>
 #include <iomanip>
+#include <utility>
+#include <tuple>
 #include "pss_sched_utils.hpp"
 #include "pss_exception.hpp"
 
@@ -18,16 +20,19 @@ namespace pss {
 
 typedef unsigned seq_id;
 
+//operator of the steps in cells that are not operator-limited
+static const Symbol kAnyOpr("any");
+
 void FindRoutes(vector<Route>      &routes,
                 vector<Func> const &funcseqs,
                 int                 maxcellhops,
                 Route              &cur,
                 set<seq_id>        &closed,
                 set<string>        &rsrcs,
-                One2Many const     &seq2cell) {
+                Seq2Cells const    &seq2cell) {
   vector<string>::const_iterator rin, rout;
-  set<string>::const_iterator c;
-  string lastcell;
+  SymbolSet::const_iterator c;
+  Symbol lastcell;
   Fstep nextstep;
   int newmaxhops;
   bool apply;
@@ -39,7 +44,7 @@ void FindRoutes(vector<Route>      &routes,
   if(!cur.empty())
     lastcell = cur.back().cell;
   else
-    lastcell = "";
+    lastcell = Symbol();
   for(seq_id s = 0; s < funcseqs.size(); ++s) {
     //cerr << "funcseqs[" << s << "] = " << funcseqs[s].name << endl;
     if(closed.find(s) != closed.end())
@@ -59,14 +64,16 @@ void FindRoutes(vector<Route>      &routes,
     if(apply) {
       //cerr << " -> applicable" << endl;
       closed.insert(s);
-      nextstep.funcseq = funcseqs[s].name;
-      nextstep.seqid = s;
-      One2Many::const_iterator s2cItr = seq2cell.find(nextstep.funcseq);
+      Seq2Cells::const_iterator s2cItr = seq2cell.find(funcseqs[s].name);
       if(s2cItr == seq2cell.end()) {
-        throw RuntimeException("Function sequence not found: " + nextstep.funcseq);
+        throw RuntimeException("Function sequence not found: " +
+                               funcseqs[s].name);
       }
-      for(c = s2cItr->second.begin(); c != s2cItr->second.end(); ++c) {
-        if(*c == lastcell || lastcell == "")
+      nextstep.funcseq = s2cItr->second.funcseq;
+      nextstep.seqid = s;
+      const SymbolSet &cells = s2cItr->second.cells;
+      for(c = cells.begin(); c != cells.end(); ++c) {
+        if(*c == lastcell || lastcell.empty())
           newmaxhops = maxcellhops;
         else
           newmaxhops = maxcellhops - 1;
@@ -89,7 +96,7 @@ void FindRoutes(vector<Route>      &routes,
 }
 
 int FindMinhopRoutes(vector<Route> &routes, vector<Func> const &funcseqs,
-                     One2Many const &seq2cell) {
+                     Seq2Cells const &seq2cell) {
   Route cur;
   unsigned int maxcellhops;
   set<seq_id> closed;
@@ -122,7 +129,7 @@ int FindMinhopRoutes(vector<Route> &routes, vector<Func> const &funcseqs,
 
 void SchedStepQuantities(SchedStep &schedstep, double setup0, double setup1,
                          double speedval, int quantity) {
-  vector<Tintvl>::const_iterator t;
+  StepTintvls::const_iterator t;
   time_t totdur, stime, dur;
   int qty;
 
@@ -171,8 +178,8 @@ void SchedStepQuantities(SchedStep &schedstep, double setup0, double setup1,
 
 void PrintSchedDebugInfo(Sched &sched) {
   Sched::const_iterator s;
-  vector<Tintvl>::const_iterator t;
-  vector<int>::const_iterator q;
+  StepTintvls::const_iterator t;
+  StepQuantities::const_iterator q;
   string time_str;
 
   for(s = sched.begin(); s != sched.end(); ++s) {
@@ -191,10 +198,17 @@ void PrintSchedDebugInfo(Sched &sched) {
   }
 }
 
-void TintvlSetUnion(TintvlSet &set1, TintvlSet &set2, TintvlSet &tintvl_union) {
-  tintvl_union.clear();
-  set_union(set1.begin(), set1.end(), set2.begin(), set2.end(),
-            inserter(tintvl_union, tintvl_union.begin()), LtTintvl());
+RsrcTintvls &ResourceTintvls(Rsrc2Tintvl &rsrc2tintvl, const string &rsrc) {
+  Rsrc2Tintvl::iterator it = rsrc2tintvl.lower_bound(rsrc);
+  if(it != rsrc2tintvl.end() && it->first == rsrc) {
+    if(!it->second.empty() || it->second.get_allocator().pool() != NULL)
+      return it->second;
+    //an empty timeline left behind by operator[]; replaced by a pooled one
+    rsrc2tintvl.erase(it++);
+  }
+  //the set is built in place around the new pool, which it owns from then on
+  return rsrc2tintvl.emplace_hint(it, piecewise_construct, forward_as_tuple(rsrc),
+                                  forward_as_tuple(new NodePool()))->second;
 }
 
 void InsertMachTintvl(Rsrc2Tintvl &rsrc2tintvl, const SchedStep &schedstep) {
@@ -204,7 +218,7 @@ void InsertMachTintvl(Rsrc2Tintvl &rsrc2tintvl, const SchedStep &schedstep) {
 
 void RemoveMachTintvl(Rsrc2Tintvl &rsrc2tintvl, SchedStep &schedstep) {
   TintvlSet &tintvls = rsrc2tintvl[schedstep.step.station];
-  vector<Tintvl>::const_iterator t;
+  StepTintvls::const_iterator t;
 
   for(t = schedstep.mach_tintvls.begin(); t != schedstep.mach_tintvls.end(); ++t)
     tintvls.erase(*t);
@@ -212,17 +226,21 @@ void RemoveMachTintvl(Rsrc2Tintvl &rsrc2tintvl, SchedStep &schedstep) {
 
 void InsertMachTintvl(Rsrc2Tintvl &rsrc2tintvl, const Sched &sched) {
   Sched::const_iterator s;
+  StepTintvls::const_iterator t;
 
-  for(s = sched.begin(); s != sched.end(); ++s)
-    rsrc2tintvl[(*s).step.station].insert((*s).mach_tintvls.begin(),
-                                          (*s).mach_tintvls.end());
+  for(s = sched.begin(); s != sched.end(); ++s) {
+    RsrcTintvls &tintvls = ResourceTintvls(rsrc2tintvl, (*s).step.station);
+    for(t = (*s).mach_tintvls.begin(); t != (*s).mach_tintvls.end(); ++t)
+      if(tintvls.insert(*t).second)
+        tintvls.busy.Occupy(*t);
+  }
 }
 
 void AddOprTintvl(Rsrc2Tintvl &rsrc2tintvl, const Sched &sched) {
   Sched::const_iterator s;
 
   for(s = sched.begin(); s != sched.end(); ++s) {
-    TintvlSet &oprtintvl = rsrc2tintvl[(*s).step.opr];
+    TintvlSet &oprtintvl = ResourceTintvls(rsrc2tintvl, (*s).step.opr);
     TintvlSetAdd(oprtintvl, (*s).opr_tintvls, oprtintvl);
   }
 }
@@ -241,9 +259,9 @@ void SimplifyOprTintvl(Sched &sched) {
   }
 }
 
-int CompareTintvlEndTime(const vector<Tintvl> &tintvls1,
-                         const vector<Tintvl> &tintvls2) {
-  vector<Tintvl>::const_reverse_iterator t1, t2;
+int CompareTintvlEndTime(const StepTintvls &tintvls1,
+                         const StepTintvls &tintvls2) {
+  StepTintvls::const_reverse_iterator t1, t2;
 
   for(t1 = tintvls1.rbegin(), t2 = tintvls2.rbegin();
       t1 != tintvls1.rend() && t2 != tintvls2.rend();
@@ -303,6 +321,68 @@ time_t AttributeSetupTimeSum(const map<string, time_t> &sfuncAttr) {
   return setupTime;
 }
 
+//calendar bitmap of 'station', or NULL if none has been built
+static const CalendarBitmap *StationCalendarBitmap(const ShopInfo &shopInfo,
+                                                   const string &station) {
+  if(shopInfo.calbits.empty())
+    return NULL;
+  return &shopInfo.calbits[shopInfo.mach2cal.find(station)->second];
+}
+
+//bitmap of the intersection of the calendars of 'station' and 'opr', or NULL
+//if none has been built
+static const CalendarBitmap *OprCalendarBitmap(const ShopInfo &shopInfo,
+                                               const string &station,
+                                               const string &opr) {
+  map<string, CalendarId>::const_iterator m = shopInfo.mach2cal.find(station);
+  map<string, CalendarId>::const_iterator o = shopInfo.opr2cal.find(opr);
+  if(m == shopInfo.mach2cal.end() || o == shopInfo.opr2cal.end())
+    return NULL;
+  map<pair<CalendarId, CalendarId>, CalendarBitmap>::const_iterator c =
+    shopInfo.calpair2bits.find(make_pair(m->second, o->second));
+  return c == shopInfo.calpair2bits.end() ? NULL : &c->second;
+}
+
+//true if the station calendar cannot be open long enough within [start, end)
+//to process 'quantity' units, in which case QuantityTest() is bound to fail
+static bool GapTooShort(const CalendarBitmap *calbits, const int quantity,
+                        const double unitdur, const time_t start,
+                        const time_t end) {
+  return calbits &&
+         !MayHold(calbits->OpenSecsUpperBound(start, end), quantity * unitdur);
+}
+
+//same as GapTooShort() for the calendar shared by a station and an operator
+//('calbits' from OprCalendarBitmap()): EarliestSlotOprltd() and
+//QuantityTestOprltd() run the station at most twice as long as the operator
+//attends it, and only while both calendars are open when the operator starts
+static bool OprGapTooShort(const CalendarBitmap *calbits, const int quantity,
+                           const double unitdur, const time_t start,
+                           const time_t end) {
+  return calbits &&
+         !MayHold(calbits->OpenSecsUpperBound(start, end), quantity * unitdur / 2.);
+}
+
+//returns the last interval of 'tintvls' (at or after 'i') that starts before
+//the first stretch of free station time past 'i' that may hold 'secs' seconds
+//of work, s.t. the gaps up to there need not be tested one by one
+static TintvlUnion::const_iterator SkipShortGaps(const TintvlUnion &tintvls,
+    TintvlUnion::const_iterator i, const RsrcTintvls &committed,
+    const CalendarBitmap *calbits, const double secs) {
+#ifdef PSS_TRADE_QUALITY_FOR_SPEED
+  //gaps past 'min_ends_before' must not be skipped
+  return i;
+#endif
+  if(!calbits || !committed.busy.InSync(committed.size()))
+    return i;
+  Tintvl tintvl;
+  tintvl.start = committed.busy.FirstFit(*calbits, (*i).end + 1, secs);
+  if(tintvl.start <= (*i).end + 1)
+    return i;
+  i = tintvls.upper_bound(tintvl);
+  return --i;
+}
+
 void FindSched(SchedInfo &schedInfo, const ShopJob *job,
                Route const &route, Rsrc2Tintvl &mach2tintvl,
                Rsrc2Tintvl &opr2tintvl, ShopInfo const &shopInfo,
@@ -339,7 +419,7 @@ void FindSched(SchedInfo &schedInfo, const ShopJob *job,
 #endif
   double unitdur;
   vector<string>::const_iterator rin, rout;
-  TintvlSet::iterator i;
+  TintvlUnion::const_iterator i;
   int quantity;
 
   //assumes NOW (or earliest schedulable time) < arrival !!!
@@ -378,7 +458,7 @@ void FindSched(SchedInfo &schedInfo, const ShopJob *job,
   while(s != sfuncset.end()) {
     schedstep.step = curstep;
     schedstep.step.station = (*s).station;
-    schedstep.step.opr = "any";
+    schedstep.step.opr = kAnyOpr;
     //cerr << "Step id = " << cur << "-> trying station: " << setw(10) << (*s).station;
     schedstep.mach_tintvls.clear();
     //assumes NOW (or earliest schedulable time) < est_start !!!
@@ -396,14 +476,14 @@ void FindSched(SchedInfo &schedInfo, const ShopJob *job,
     }
     FuncInfo tmp = (*s).funcseq.funcinfo;
     unitdur = 1.0 / (*s).funcseq.funcinfo.speedval;
-    TintvlSet utintvls;
-    bool jobmach_empty = schedInfo.jobmach2tintvl[(*s).station].empty();
-    if(!jobmach_empty)
-      TintvlSetUnion(mach2tintvl[(*s).station],
-                     schedInfo.jobmach2tintvl[(*s).station], utintvls);
-    TintvlSet &tintvls = jobmach_empty ? mach2tintvl[(*s).station] : utintvls;
-    TintvlVec2d const &weekts = shopInfo.mach2weekts.find((*s).station)->second;
-    DayTs const &dayts = shopInfo.mach2dayts.find((*s).station)->second;
+    const RsrcTintvls &committed = mach2tintvl[(*s).station];
+    TintvlUnion tintvls(committed, schedInfo.jobmach2tintvl[(*s).station]);
+    const Calendar &calendar = MachCalendar(shopInfo, (*s).station);
+    TintvlVec2d const &weekts = calendar.weekts;
+    DayTs const &dayts = calendar.dayts;
+    const CalendarKind calkind = calendar.kind;
+    const LocalTimeTable &localtime = shopInfo.localtime;
+    const CalendarBitmap *calbits = StationCalendarBitmap(shopInfo, (*s).station);
     start = est_start;
     bool is_first_batch = true;
     if(!tintvls.empty()) {
@@ -427,7 +507,8 @@ void FindSched(SchedInfo &schedInfo, const ShopJob *job,
         if(start < min_ends_before) {
           nxt_start = numeric_limits<time_t>::max();
           QuantityTest(quantity, unitdur, stime0 + stimeAttr, stime1, is_first_batch,
-                       start, nxt_start, weekts, dayts, ends_before); //just to get "ends_before"
+                       start, nxt_start, weekts, dayts, localtime, ends_before,
+                       calkind); //just to get "ends_before"
         }
 #endif
       } else {
@@ -454,9 +535,12 @@ void FindSched(SchedInfo &schedInfo, const ShopJob *job,
 #ifdef PSS_TRADE_QUALITY_FOR_SPEED
           start < min_ends_before &&
 #endif
-          !QuantityTest(quantity, unitdur, stime0 + stimeAttr, stime1,
-                        is_first_batch, start, nxt_start, weekts, dayts, ends_before)) {
+          (GapTooShort(calbits, quantity, unitdur, start, nxt_start) ||
+           !QuantityTest(quantity, unitdur, stime0 + stimeAttr, stime1,
+                         is_first_batch, start, nxt_start, weekts, dayts, localtime,
+                         ends_before, calkind))) {
           //cannot squeeze in between
+          i = SkipShortGaps(tintvls, i, committed, calbits, quantity * unitdur);
           if((*i).intid != job->intid || (*i).seqid != curSeqId) {
             stime0 = stime1;
             const One2One &prevAttr =
@@ -473,9 +557,11 @@ void FindSched(SchedInfo &schedInfo, const ShopJob *job,
             start < min_ends_before &&
 #endif
             i != tintvls.end() &&
-            !QuantityTest(quantity, unitdur, stime0 + stimeAttr, stime1,
-                          is_first_batch, start, (*i).start, weekts,
-                          dayts, ends_before)) {
+            (GapTooShort(calbits, quantity, unitdur, start, (*i).start) ||
+             !QuantityTest(quantity, unitdur, stime0 + stimeAttr, stime1,
+                           is_first_batch, start, (*i).start, weekts,
+                           dayts, localtime, ends_before, calkind))) {
+            i = SkipShortGaps(tintvls, i, committed, calbits, quantity * unitdur);
             if((*i).intid != job->intid || (*i).seqid != curSeqId) {
               stime0 = stime1;
               const One2One &prevAttr =
@@ -499,7 +585,8 @@ void FindSched(SchedInfo &schedInfo, const ShopJob *job,
     if(start < min_ends_before) {
       nxt_start = numeric_limits<time_t>::max();
       QuantityTest(quantity, unitdur, stime0 + stimeAttr, stime1, is_first_batch,
-                   start, nxt_start, weekts, dayts, ends_before); //just to get "ends_before"
+                   start, nxt_start, weekts, dayts, localtime, ends_before,
+                   calkind); //just to get "ends_before"
     }
 #endif
     //for debugging:
@@ -530,7 +617,7 @@ void FindSched(SchedInfo &schedInfo, const ShopJob *job,
 #endif
     EarliestSlot(schedstep.mach_tintvls, job->intid, curSeqId, is_first_batch,
                  start, stime0 + stimeAttr, stime1, quantity, unitdur,
-                 weekts, dayts);
+                 weekts, dayts, localtime, calkind);
 
     //for debugging:
     //string time_str;
@@ -565,10 +652,10 @@ void FindSched(SchedInfo &schedInfo, const ShopJob *job,
   }
 }
 
-set<string> const &EligibleOprs(bool const oprltd, bool const useoprskills,
-                                set<string> const &skilled_oprs,
-                                set<string> const &any_opr,
-                                set<string> const &last_opr) {
+SymbolSet const &EligibleOprs(bool const oprltd, bool const useoprskills,
+                              SymbolSet const &skilled_oprs,
+                              SymbolSet const &any_opr,
+                              SymbolSet const &last_opr) {
   if(oprltd) {
     if(useoprskills) {
       if(!last_opr.empty() &&
@@ -583,10 +670,27 @@ set<string> const &EligibleOprs(bool const oprltd, bool const useoprskills,
   return any_opr;
 }
 
+//returns the timeline of 'opr' including the job's own (tentative) intervals;
+//such sums are kept in 'opr2sum', which must be cleared once they change
+static TintvlSet &OprTintvlsWithJob(map<string, TintvlSet> &opr2sum,
+                                    Rsrc2Tintvl &opr2tintvl,
+                                    Rsrc2Tintvl &jobopr2tintvl,
+                                    const string &opr) {
+  TintvlSet &jobopr_tintvls = jobopr2tintvl[opr];
+  if(jobopr_tintvls.empty())
+    return opr2tintvl[opr];
+  map<string, TintvlSet>::iterator sum = opr2sum.find(opr);
+  if(sum == opr2sum.end()) {
+    sum = opr2sum.insert(make_pair(opr, TintvlSet())).first;
+    TintvlSetAdd(opr2tintvl[opr], jobopr_tintvls, sum->second);
+  }
+  return sum->second;
+}
+
 void FindSchedOprltd(SchedInfo &schedInfo, const ShopJob *job,
                      Route const &route, Rsrc2Tintvl &mach2tintvl,
                      Rsrc2Tintvl &opr2tintvl, ShopInfo const &shopInfo,
-                     const vector<ShopJob *> &all_job_ptrs, string lastopr) {
+                     const vector<ShopJob *> &all_job_ptrs, const Symbol &lastopr) {
   if(schedInfo.cur == route.size()) {
     if(!schedInfo.best.empty()) {
       time_t best_end = schedInfo.best.back().mach_tintvls.back().end;
@@ -608,46 +712,52 @@ void FindSchedOprltd(SchedInfo &schedInfo, const ShopJob *job,
   const One2One &curAttr = curfuncseq.attributes;
   SfuncSet const &sfuncset =
     shopInfo.seq2mach.find(curstep.cell)->second.find(curstep.funcseq)->second;
-  set<string> any_opr, last_opr;
+  SymbolSet any_opr, last_opr;
   const bool oprltd = shopInfo.cell2config.find(curstep.cell)->second.oprlimited;
   if(!oprltd)
-    any_opr.insert("any");
+    any_opr.insert(kAnyOpr);
   else if(!lastopr.empty())
     last_opr.insert(lastopr);
   const bool useoprskills = shopInfo.cell2config.find(curstep.cell)->second.useoprskills;
   const bool useoprschds = shopInfo.cell2config.find(curstep.cell)->second.useoprschds;
-  map<string, pss::One2Many>::const_iterator c2s2oItr = shopInfo.seq2opr.find(curstep.cell);
+  map<string, pss::One2Symbols>::const_iterator c2s2oItr = shopInfo.seq2opr.find(curstep.cell);
   if(c2s2oItr == shopInfo.seq2opr.end()) {
     throw RuntimeException("Unable to find an operator for function sequence: "
-                           + curstep.funcseq + " in cell: " + curstep.cell);
+                           + curstep.funcseq.str() + " in cell: "
+                           + curstep.cell.str());
   }
-  One2Many::const_iterator s2oItr = c2s2oItr->second.find(curstep.funcseq);
+  One2Symbols::const_iterator s2oItr = c2s2oItr->second.find(curstep.funcseq);
   if(s2oItr == c2s2oItr->second.end()) {
     throw RuntimeException("Unable to find an operator for function sequence: "
-                           + curstep.funcseq + " in cell: " + curstep.cell);
+                           + curstep.funcseq.str() + " in cell: "
+                           + curstep.cell.str());
   }
-  set<string> const &skilled_oprs = s2oItr->second;
-  set<string> const &oprs = EligibleOprs(oprltd, useoprskills,
-                                         skilled_oprs, any_opr, last_opr);
+  SymbolSet const &skilled_oprs = s2oItr->second;
+  SymbolSet const &oprs = EligibleOprs(oprltd, useoprskills,
+                                       skilled_oprs, any_opr, last_opr);
   if(oprs.empty()) {
     throw RuntimeException("Unable to find an operator for function sequence: "
-                           + curstep.funcseq + " in cell: " + curstep.cell);
+                           + curstep.funcseq.str() + " in cell: "
+                           + curstep.cell.str());
   }
   SfuncSet::const_iterator s;
-  set<string>::const_iterator o;
+  SymbolSet::const_iterator o;
   SchedStep schedstep;
   Tintvl tintvl;
   time_t rsrctm, start, est_start, nxt_start, stime0, stime1, ends_before;
 #ifdef PSS_TRADE_QUALITY_FOR_SPEED
   time_t min_ends_before = numeric_limits<time_t>::max();
   SfuncSet::const_iterator s_min_end = sfuncset.end();
-  set<string>::const_iterator o_min_end = oprs.end();
+  SymbolSet::const_iterator o_min_end = oprs.end();
   bool schedule_min_end = false;
 #endif
   double unitdur;
   vector<string>::const_iterator rin, rout;
-  TintvlSet::iterator i;
+  TintvlUnion::const_iterator i;
   int quantity, oprdemand;
+  //operator timelines summed with the job's, shared by all stations
+  //until the next recursion changes the job's intervals
+  map<string, TintvlSet> opr2sum;
 
   //assumes NOW (or earliest schedulable time) < arrival !!!
   //otherwise: est_start = max (arrival, earliest schedulable time of shop)
@@ -703,15 +813,14 @@ void FindSchedOprltd(SchedInfo &schedInfo, const ShopJob *job,
     }
     unitdur = 1.0 / (*s).funcseq.funcinfo.speedval;
 
-    TintvlSet mach_tintvls_union;
-    bool jobmach_empty = schedInfo.jobmach2tintvl[(*s).station].empty();
-    if(!jobmach_empty)
-      TintvlSetUnion(mach2tintvl[(*s).station],
-                     schedInfo.jobmach2tintvl[(*s).station], mach_tintvls_union);
-    TintvlSet &mach_tintvls =
-      jobmach_empty ? mach2tintvl[(*s).station] : mach_tintvls_union;
-    TintvlVec2d const &mweekts = shopInfo.mach2weekts.find((*s).station)->second;
-    DayTs const &mdayts = shopInfo.mach2dayts.find((*s).station)->second;
+    const RsrcTintvls &committed = mach2tintvl[(*s).station];
+    TintvlUnion mach_tintvls(committed, schedInfo.jobmach2tintvl[(*s).station]);
+    const Calendar &mcalendar = MachCalendar(shopInfo, (*s).station);
+    TintvlVec2d const &mweekts = mcalendar.weekts;
+    DayTs const &mdayts = mcalendar.dayts;
+    const CalendarKind mcalkind = mcalendar.kind;
+    const LocalTimeTable &localtime = shopInfo.localtime;
+    const CalendarBitmap *calbits = StationCalendarBitmap(shopInfo, (*s).station);
 
     o = oprs.begin();
 #ifdef PSS_TRADE_QUALITY_FOR_SPEED
@@ -727,16 +836,13 @@ void FindSchedOprltd(SchedInfo &schedInfo, const ShopJob *job,
       schedstep.opr_tintvls.clear();
       //assumes NOW (or earliest schedulable time) < est_start !!!
       //otherwise: schedstep.tintvl.start = max (est_start, earliest schedulable time of this station)
-      TintvlSet opr_tintvls_sum;
-      bool jobopr_empty = schedInfo.jobopr2tintvl[*o].empty();
-      if(!jobopr_empty)
-        TintvlSetAdd(opr2tintvl[*o], schedInfo.jobopr2tintvl[*o], opr_tintvls_sum);
-      TintvlSet &opr_tintvls = jobopr_empty ? opr2tintvl[*o] : opr_tintvls_sum;
-      TintvlVec2d const &oweekts =
-        useoprschds ? shopInfo.opr2weekts.find(*o)->second :
-        shopInfo.opr2weekts.find("any")->second;
-      DayTs const &odayts = useoprschds ? shopInfo.opr2dayts.find(*o)->second :
-                            shopInfo.opr2dayts.find("any")->second;
+      TintvlSet &opr_tintvls =
+        OprTintvlsWithJob(opr2sum, opr2tintvl, schedInfo.jobopr2tintvl, *o);
+      const Calendar &ocalendar = OprCalendar(shopInfo, useoprschds ? *o : kAnyOpr);
+      TintvlVec2d const &oweekts = ocalendar.weekts;
+      DayTs const &odayts = ocalendar.dayts;
+      const CalendarBitmap *oprcalbits =
+        useoprschds ? OprCalendarBitmap(shopInfo, (*s).station, *o) : NULL;
 
       start = est_start;
       bool is_first_batch = true;
@@ -763,7 +869,8 @@ void FindSchedOprltd(SchedInfo &schedInfo, const ShopJob *job,
             nxt_start = numeric_limits<time_t>::max();
             QuantityTestOprltd(quantity, unitdur, stime0 + stimeAttr, stime1, is_first_batch,
                                start, nxt_start, mweekts, mdayts, oprdemand, opr_tintvls,
-                               oweekts, odayts, ends_before); //just to get "ends_before"
+                               oweekts, odayts, localtime, ends_before,
+                               mcalkind); //just to get "ends_before"
           }
 #endif
         } else {
@@ -791,9 +898,14 @@ void FindSchedOprltd(SchedInfo &schedInfo, const ShopJob *job,
 #ifdef PSS_TRADE_QUALITY_FOR_SPEED
             start < min_ends_before &&
 #endif
-            !QuantityTestOprltd(quantity, unitdur, stime0 + stimeAttr, stime1, is_first_batch, start, nxt_start, mweekts, mdayts,
-                                oprdemand, opr_tintvls, oweekts, odayts, ends_before)) {
+            (GapTooShort(calbits, quantity, unitdur, start, nxt_start) ||
+             OprGapTooShort(oprcalbits, quantity, unitdur, start, nxt_start) ||
+             !QuantityTestOprltd(quantity, unitdur, stime0 + stimeAttr, stime1, is_first_batch, start, nxt_start, mweekts, mdayts,
+                                 oprdemand, opr_tintvls, oweekts, odayts, localtime,
+                                 ends_before, mcalkind))) {
             //cannot squeeze in between
+            i = SkipShortGaps(mach_tintvls, i, committed, calbits,
+                              quantity * unitdur);
             if((*i).intid != job->intid || (*i).seqid != curSeqId) {
               stime0 = stime1;
               const One2One &prevAttr = all_job_ptrs[(*i).intid]->funcseqs[(*i).seqid].attributes;
@@ -809,11 +921,15 @@ void FindSchedOprltd(SchedInfo &schedInfo, const ShopJob *job,
               start < min_ends_before &&
 #endif
               i != mach_tintvls.end() &&
-              !QuantityTestOprltd(quantity, unitdur, stime0 + stimeAttr,
-                                  stime1, is_first_batch, start,
-                                  (*i).start, mweekts, mdayts,
-                                  oprdemand, opr_tintvls, oweekts,
-                                  odayts, ends_before)) {
+              (GapTooShort(calbits, quantity, unitdur, start, (*i).start) ||
+               OprGapTooShort(oprcalbits, quantity, unitdur, start, (*i).start) ||
+               !QuantityTestOprltd(quantity, unitdur, stime0 + stimeAttr,
+                                   stime1, is_first_batch, start,
+                                   (*i).start, mweekts, mdayts,
+                                   oprdemand, opr_tintvls, oweekts,
+                                   odayts, localtime, ends_before, mcalkind))) {
+              i = SkipShortGaps(mach_tintvls, i, committed, calbits,
+                                quantity * unitdur);
               if((*i).intid != job->intid || (*i).seqid != curSeqId) {
                 stime0 = stime1;
                 //const One2One &prevAttr = all_job_ptrs[(*i).intid]->funcseqs[(*i).seqid].attributes;
@@ -843,7 +959,8 @@ void FindSchedOprltd(SchedInfo &schedInfo, const ShopJob *job,
                            stime1, is_first_batch,
                            start, nxt_start, mweekts, mdayts,
                            oprdemand, opr_tintvls,
-                           oweekts, odayts, ends_before); //just to get "ends_before"
+                           oweekts, odayts, localtime, ends_before,
+                           mcalkind); //just to get "ends_before"
       }
 #endif
       //for debugging:
@@ -882,7 +999,8 @@ void FindSchedOprltd(SchedInfo &schedInfo, const ShopJob *job,
                          job->intid, curSeqId,
                          is_first_batch, start, stime0 + stimeAttr,
                          stime1, quantity, unitdur, mweekts, mdayts,
-                         oprdemand, opr_tintvls, oweekts, odayts);
+                         oprdemand, opr_tintvls, oweekts, odayts, localtime,
+                         mcalkind);
 
       //for debugging:
       //string time_str;
@@ -908,6 +1026,7 @@ void FindSchedOprltd(SchedInfo &schedInfo, const ShopJob *job,
       RemoveMachTintvl(schedInfo.jobmach2tintvl, schedstep);
 
       TintvlSetSubtract(joboprtintvl, schedstep.opr_tintvls, joboprtintvl);
+      opr2sum.clear();
       //TintvlSetSimplify(joboprtintvl); //does not seem to help
 #ifdef PSS_TRADE_QUALITY_FOR_SPEED
       break; // exit the while loop for speed
@@ -1072,7 +1191,7 @@ bool TintvlLessThan(const Tintvl &tintvl1, const Tintvl &tintvl2) {
 }
 
 //merge consecutive tintvls into a single one
-unsigned SimplifySchedStep(SchedStep &simplified, const SchedStep step) {
+unsigned SimplifySchedStep(SchedStep &simplified, const SchedStep &step) {
   map<Tintvl, int, LtTintvl> t2q;
   map<Tintvl, int, LtTintvl>::const_iterator tq;
   simplified.step = step.step;
@@ -1083,7 +1202,7 @@ unsigned SimplifySchedStep(SchedStep &simplified, const SchedStep step) {
   //sort(step.mach_tintvls.begin(), step.mach_tintvls.end(), TintvlLessThan);
   simplified.mach_tintvls.clear();
   simplified.quantities.clear();
-  int quantity;
+  int quantity = 0;
   Tintvl tintvl;
   unsigned merge_counter = 0;
   for(tq = t2q.begin(); tq != t2q.end(); ++tq) {
@@ -1131,7 +1250,7 @@ unsigned MergeBatchScheds(Sched &best, vector<Sched> &batch_scheds) {
       SchedStep &schedstep = batch_scheds[b][s];
       m = stepmerged.find(schedstep.step);
       if(m == stepmerged.end())
-        stepmerged[schedstep.step] = schedstep;
+        stepmerged[schedstep.step] = std::move(schedstep);
       else {
         m->second.mach_tintvls.insert(m->second.mach_tintvls.end(),
                                       schedstep.mach_tintvls.begin(),
@@ -1156,7 +1275,7 @@ unsigned MergeBatchScheds(Sched &best, vector<Sched> &batch_scheds) {
              "Number of merged batches less than total number of batches");
       if(merged < min_merged)
         min_merged = merged;
-      best.push_back(simplified);
+      best.push_back(std::move(simplified));
     }
   }
   if(min_merged == numeric_limits<unsigned>::max())
@@ -1295,10 +1414,10 @@ void FindMinCompletionSched(Sched &sched, ShopJob *job,
                     shopInfo, all_job_ptrs);
         else
           FindSchedOprltd(schedInfo, job, *r, mach2tintvl, opr2tintvl,
-                          shopInfo, all_job_ptrs, "");
+                          shopInfo, all_job_ptrs, Symbol());
         CommitSchedule(schedInfo.best, schedInfo.jobmach2tintvl,
                        schedInfo.jobopr2tintvl);
-        batch_scheds.push_back(schedInfo.best);
+        batch_scheds.push_back(std::move(schedInfo.best));
         //for debugging:
         //cerr << "batch = " << b << endl;
         //PrintUnitRsrcTintvl(schedInfo.jobmach2tintvl);
@@ -1315,13 +1434,13 @@ void FindMinCompletionSched(Sched &sched, ShopJob *job,
                   shopInfo, all_job_ptrs);
       else
         FindSchedOprltd(schedInfo, job, *r, mach2tintvl, opr2tintvl,
-                        shopInfo, all_job_ptrs, "");
+                        shopInfo, all_job_ptrs, Symbol());
 
-      best = schedInfo.best;
+      best.swap(schedInfo.best);
     }
     if(best.back().mach_tintvls.back().end < mincompletion) {
       mincompletion = best.back().mach_tintvls.back().end;
-      sched = best;
+      sched.swap(best);
       job->numbatches = num_batches;
     }
   }
@@ -1377,7 +1496,7 @@ void BuildSeqId2SchedIdsMap(map<unsigned, vector<unsigned> > &seqid2schedids,
 }
 
 int GetSchedStepQuantity(const SchedStep &schedstep) {
-  vector<int>::const_iterator q;
+  StepQuantities::const_iterator q;
   int sum = 0;
 
   for(q = schedstep.quantities.begin(); q != schedstep.quantities.end(); ++q)
@@ -1429,7 +1548,7 @@ void ValidateSched(map<unsigned, Sched> &scheds, vector<ShopJob> &shop_jobs,
         const SchedStep &step = sched[*si];
         assert(step.step.funcseq == (*j).funcseqs[step.step.seqid].name);
         int quantity = GetSchedStepQuantity(step);
-        vector<Tintvl>::const_iterator t;
+        StepTintvls::const_iterator t;
         for(t = step.mach_tintvls.begin(); t != step.mach_tintvls.end(); ++t) {
           assert(mach2tintvl[step.step.station].find(*t) !=
                  mach2tintvl[step.step.station].end());
@@ -1515,123 +1634,160 @@ int CompareFuncVector(const vector<Func> &funcVec1, const vector<Func> &funcVec2
   return 1;
 }
 
-bool FIFO(const ShopJob *job1, const ShopJob *job2) {
-  if(job1->arrival < job2->arrival)
+time_t GetMakespan(const Rsrc2Tintvl &rsrc2tintvl, time_t &start, time_t &end) {
+  Rsrc2Tintvl::const_iterator r;
+  Tintvl tintvl;
+  time_t mintime, maxtime;
+
+  mintime = numeric_limits<time_t>::max();
+  maxtime = numeric_limits<time_t>::min();
+  for(r = rsrc2tintvl.begin(); r != rsrc2tintvl.end(); ++r) {
+    if(!r->second.empty()) {
+      tintvl = *(r->second.begin());
+      if(tintvl.start < mintime)
+        mintime = tintvl.start;
+      tintvl = *(r->second.rbegin());
+      if(tintvl.end > maxtime)
+        maxtime = tintvl.end;
+    }
+  }
+  start = mintime;
+  end = maxtime;
+  if(maxtime > mintime)
+    return (maxtime - mintime);
+  return 0;
+}
+
+//the sequencing policies; jobs with the same function sequence attributes
+//have the same 'attrrank' (see SortShopJobs())
+static bool FIFOKey(const JobSortKey &job1, const JobSortKey &job2) {
+  if(job1.arrival < job2.arrival)
     return true;
-  if(job1->arrival > job2->arrival)
+  if(job1.arrival > job2.arrival)
     return false;
 #ifndef PSS_NO_SORTED_ATTRIBUTE
-  int funcseqCompareCode = CompareFuncVector(job1->funcseqs, job2->funcseqs);
-  if(funcseqCompareCode < 0)
+  if(job1.attrrank < job2.attrrank)
     return true;
-  if(funcseqCompareCode > 0)
+  if(job1.attrrank > job2.attrrank)
     return false;
 #endif
-  if(job1->due < job2->due)
+  if(job1.due < job2.due)
     return true;
-  if(job1->due > job2->due)
+  if(job1.due > job2.due)
     return false;
-  if(job1->due - job1->arrival < job2->due - job2->arrival)
+  if(job1.due - job1.arrival < job2.due - job2.arrival)
     return true;
   return false;
 }
 
-bool EarliestDue(const ShopJob *job1, const ShopJob *job2) {
-  if(job1->due < job2->due)
+static bool EarliestDueKey(const JobSortKey &job1, const JobSortKey &job2) {
+  if(job1.due < job2.due)
     return true;
-  if(job1->due > job2->due)
+  if(job1.due > job2.due)
     return false;
 #ifndef PSS_NO_SORTED_ATTRIBUTE
-  int funcseqCompareCode = CompareFuncVector(job1->funcseqs, job2->funcseqs);
-  if(funcseqCompareCode < 0)
+  if(job1.attrrank < job2.attrrank)
     return true;
-  if(funcseqCompareCode > 0)
+  if(job1.attrrank > job2.attrrank)
     return false;
 #endif
-  if(job1->due - job1->arrival < job2->due - job2->arrival)
+  if(job1.due - job1.arrival < job2.due - job2.arrival)
     return true;
-  if(job1->due - job1->arrival > job2->due - job2->arrival)
+  if(job1.due - job1.arrival > job2.due - job2.arrival)
     return false;
-  if(job1->arrival < job2->arrival)
+  if(job1.arrival < job2.arrival)
     return true;
   return false;
 }
 
-bool LeastSlack(const ShopJob *job1, const ShopJob *job2) {
-  if(job1->due - job1->arrival < job2->due - job2->arrival)
+static bool LeastSlackKey(const JobSortKey &job1, const JobSortKey &job2) {
+  if(job1.due - job1.arrival < job2.due - job2.arrival)
     return true;
-  if(job1->due - job1->arrival > job2->due - job2->arrival)
+  if(job1.due - job1.arrival > job2.due - job2.arrival)
     return false;
 #ifndef PSS_NO_SORTED_ATTRIBUTE
-  int funcseqCompareCode = CompareFuncVector(job1->funcseqs, job2->funcseqs);
-  if(funcseqCompareCode < 0)
+  if(job1.attrrank < job2.attrrank)
     return true;
-  if(funcseqCompareCode > 0)
+  if(job1.attrrank > job2.attrrank)
     return false;
 #endif
-  if(job1->due < job2->due)
+  if(job1.due < job2.due)
     return true;
-  if(job1->due > job2->due)
+  if(job1.due > job2.due)
     return false;
-  if(job1->arrival < job2->arrival)
+  if(job1.arrival < job2.arrival)
     return true;
   return false;
 }
 
-bool ShortestProcTime(const ShopJob *job1, const ShopJob *job2) {
-  if(job1->proctime < job2->proctime)
+static bool ShortestProcTimeKey(const JobSortKey &job1, const JobSortKey &job2) {
+  if(job1.proctime < job2.proctime)
     return true;
-  if(job1->proctime > job2->proctime)
+  if(job1.proctime > job2.proctime)
     return false;
 #ifndef PSS_NO_SORTED_ATTRIBUTE
-  int funcseqCompareCode = CompareFuncVector(job1->funcseqs, job2->funcseqs);
-  if(funcseqCompareCode < 0)
+  if(job1.attrrank < job2.attrrank)
     return true;
-  if(funcseqCompareCode > 0)
+  if(job1.attrrank > job2.attrrank)
     return false;
 #endif
-  if(job1->due - job1->arrival < job2->due - job2->arrival)
+  if(job1.due - job1.arrival < job2.due - job2.arrival)
     return true;
-  if(job1->due - job1->arrival > job2->due - job2->arrival)
+  if(job1.due - job1.arrival > job2.due - job2.arrival)
     return false;
-  if(job1->due < job2->due)
+  if(job1.due < job2.due)
     return true;
-  if(job1->due > job2->due)
+  if(job1.due > job2.due)
     return false;
-  if(job1->arrival < job2->arrival)
+  if(job1.arrival < job2.arrival)
     return true;
   return false;
 }
 
-time_t GetMakespan(const Rsrc2Tintvl &rsrc2tintvl, time_t &start, time_t &end) {
-  Rsrc2Tintvl::const_iterator r;
-  Tintvl tintvl;
-  time_t mintime, maxtime;
-
-  mintime = numeric_limits<time_t>::max();
-  maxtime = numeric_limits<time_t>::min();
-  for(r = rsrc2tintvl.begin(); r != rsrc2tintvl.end(); ++r) {
-    if(!r->second.empty()) {
-      tintvl = *(r->second.begin());
-      if(tintvl.start < mintime)
-        mintime = tintvl.start;
-      tintvl = *(r->second.rbegin());
-      if(tintvl.end > maxtime)
-        maxtime = tintvl.end;
-    }
+struct LtFuncVector {
+  bool operator()(const vector<Func> *funcVec1, const vector<Func> *funcVec2) const {
+    return CompareFuncVector(*funcVec1, *funcVec2) < 0;
   }
-  start = mintime;
-  end = maxtime;
-  if(maxtime > mintime)
-    return (maxtime - mintime);
-  return 0;
-}
+};
 
-void InitSeqPolicyDict(map<string, OrderFptr, CaseInsensitiveLess> &dict) {
-  dict["firstInFirstOut"] = FIFO;
-  dict["earliestDue"] = EarliestDue;
-  dict["leastSlack"] = LeastSlack;
-  dict["shortestProcTime"] = ShortestProcTime;
+void SortShopJobs(vector<ShopJob *> &shop_job_ptrs, const string &sequencepolicy) {
+  typedef bool (*KeyOrderFptr)(const JobSortKey &, const JobSortKey &);
+  map<string, KeyOrderFptr, CaseInsensitiveLess> dict;
+  dict["firstInFirstOut"] = FIFOKey;
+  dict["earliestDue"] = EarliestDueKey;
+  dict["leastSlack"] = LeastSlackKey;
+  dict["shortestProcTime"] = ShortestProcTimeKey;
+  map<string, KeyOrderFptr, CaseInsensitiveLess>::const_iterator policy =
+    dict.find(sequencepolicy);
+  if(policy == dict.end())
+    throw RuntimeException("Unknown sequencing policy: " + sequencepolicy);
+
+  //jobs share few distinct function sequence attributes; rank them once
+  map<const vector<Func> *, unsigned, LtFuncVector> attr2rank;
+#ifndef PSS_NO_SORTED_ATTRIBUTE
+  for(size_t j = 0; j < shop_job_ptrs.size(); ++j)
+    attr2rank.insert(make_pair(&shop_job_ptrs[j]->funcseqs, 0u));
+  unsigned rank = 0;
+  map<const vector<Func> *, unsigned, LtFuncVector>::iterator a;
+  for(a = attr2rank.begin(); a != attr2rank.end(); ++a)
+    a->second = rank++;
+#endif
+  vector<JobSortKey> keys(shop_job_ptrs.size());
+  for(size_t j = 0; j < shop_job_ptrs.size(); ++j) {
+    ShopJob *job = shop_job_ptrs[j];
+    keys[j].arrival = job->arrival;
+    keys[j].due = job->due;
+    keys[j].proctime = job->proctime;
+#ifndef PSS_NO_SORTED_ATTRIBUTE
+    keys[j].attrrank = attr2rank.find(&job->funcseqs)->second;
+#else
+    keys[j].attrrank = 0;
+#endif
+    keys[j].job = job;
+  }
+  sort(keys.begin(), keys.end(), policy->second);
+  for(size_t j = 0; j < keys.size(); ++j)
+    shop_job_ptrs[j] = keys[j].job;
 }
 
 void SchedTintvl(Tintvl &tintvl, Sched &sched) {
@@ -1679,6 +1835,117 @@ void ScheduleJob(Sched &sched, ShopJob *shopJob, unsigned priority,
   shopJob->completed = tintvl.end;
 }
 
+//earliest end of 'quantity' units of 'funcseq' started at 'start' on
+//any station of the shop that can process it, as if the station were idle
+//and needed no setup; returns false if no station can process it
+static bool EarliestStepEnd(time_t &end, const Func &funcseq, const time_t start,
+                            const int quantity, const ShopInfo &shopInfo) {
+  Seq2Cells::const_iterator s2c = shopInfo.seq2cell.find(funcseq.name);
+  if(s2c == shopInfo.seq2cell.end())
+    return false;
+  StepTintvls tintvls;
+  end = numeric_limits<time_t>::max();
+  const SymbolSet &cells = s2c->second.cells;
+  for(SymbolSet::const_iterator c = cells.begin(); c != cells.end(); ++c) {
+    map<string, Seq2Sfunc>::const_iterator cell = shopInfo.seq2mach.find(*c);
+    if(cell == shopInfo.seq2mach.end())
+      continue;
+    Seq2Sfunc::const_iterator sfuncset = cell->second.find(funcseq.name);
+    if(sfuncset == cell->second.end())
+      continue;
+    SfuncSet::const_iterator s;
+    for(s = sfuncset->second.begin(); s != sfuncset->second.end(); ++s) {
+      const Calendar &calendar = MachCalendar(shopInfo, (*s).station);
+      tintvls.clear();
+      EarliestSlot(tintvls, 0, 0, true, start, 0, 0, quantity,
+                   1.0 / (*s).funcseq.funcinfo.speedval,
+                   calendar.weekts, calendar.dayts, shopInfo.localtime,
+                   calendar.kind);
+      if(tintvls.back().end < end)
+        end = tintvls.back().end;
+    }
+  }
+  return end != numeric_limits<time_t>::max();
+}
+
+time_t CompletionLowerBound(const ShopJob *shopJob, const ShopInfo &shopInfo) {
+  const vector<Func> &funcseqs = shopJob->funcseqs;
+  vector<Func>::const_iterator f;
+  vector<string>::const_iterator rin, rout;
+  Rsrc2Qty r2q;
+  Rsrc2Qty::iterator q;
+
+  BuildRsrcQuantityMap(r2q, shopJob->resources);
+  //a batch carries at least 1/min of every resource (see BatchSplit())
+  bool batching = false;
+  map<string, CellConfig>::const_iterator c;
+  for(c = shopInfo.cell2config.begin(); c != shopInfo.cell2config.end(); ++c)
+    batching = batching || c->second.batching;
+  if(batching && !r2q.empty()) {
+    unsigned min = numeric_limits<unsigned>::max();
+    bool divisible = true;
+    for(q = r2q.begin(); q != r2q.end(); ++q)
+      min = std::min(min, q->second);
+    for(q = r2q.begin(); q != r2q.end(); ++q)
+      divisible = divisible && min != 0 && q->second % min == 0;
+    if(divisible) {
+      for(q = r2q.begin(); q != r2q.end(); ++q)
+        q->second /= min;
+    }
+  }
+  //a resource is available no earlier than the first of its producers
+  //could end; a step is bounded once all producers of its inputs are
+  map<string, unsigned> producers;
+  for(f = funcseqs.begin(); f != funcseqs.end(); ++f) {
+    for(rout = (*f).outrsrcs.begin(); rout != (*f).outrsrcs.end(); ++rout)
+      ++producers[*rout];
+  }
+  map<string, time_t> rsrc2tm;
+  vector<bool> bounded(funcseqs.size(), false);
+  time_t completion = shopJob->arrival;
+  for(bool progress = true; progress; ) {
+    progress = false;
+    for(size_t s = 0; s < funcseqs.size(); ++s) {
+      const Func &funcseq = funcseqs[s];
+      if(bounded[s])
+        continue;
+      time_t start = shopJob->arrival;
+      bool ready = true;
+      for(rin = funcseq.inrsrcs.begin(); rin != funcseq.inrsrcs.end() && ready; ++rin) {
+        map<string, time_t>::const_iterator tm = rsrc2tm.find(*rin);
+        if(producers[*rin] > 0)
+          ready = false;
+        else if(tm != rsrc2tm.end() && tm->second > start)
+          start = tm->second;
+      }
+      if(!ready)
+        continue;
+      int quantity = 0;
+      for(rout = funcseq.outrsrcs.begin(); rout != funcseq.outrsrcs.end(); ++rout) {
+        q = r2q.find(*rout);
+        if(q == r2q.end())
+          return shopJob->arrival;
+        quantity += q->second;
+      }
+      time_t end;
+      if(quantity <= 0 || !EarliestStepEnd(end, funcseq, start, quantity, shopInfo))
+        return shopJob->arrival;
+      bounded[s] = true;
+      progress = true;
+      completion = max(completion, end);
+      for(rout = funcseq.outrsrcs.begin(); rout != funcseq.outrsrcs.end(); ++rout) {
+        --producers[*rout];
+        map<string, time_t>::iterator tm = rsrc2tm.find(*rout);
+        if(tm == rsrc2tm.end())
+          rsrc2tm[*rout] = end + 1;
+        else
+          tm->second = min(tm->second, end + 1);
+      }
+    }
+  }
+  return completion;
+}
+
 void ShopJobPointers(vector<ShopJob *> &shop_job_pointers,
                      vector<ShopJob> &shop_jobs) {
   shop_job_pointers.clear();
@@ -1687,16 +1954,20 @@ void ShopJobPointers(vector<ShopJob *> &shop_job_pointers,
   }
 }
 
+void JobsHorizon(const vector<ShopJob> &shop_jobs, time_t &from, time_t &to) {
+  for(vector<ShopJob>::const_iterator j = shop_jobs.begin(); j != shop_jobs.end(); ++j) {
+    from = min(from, j->arrival);
+    to = max(to, max(j->arrival, j->due));
+  }
+}
+
 void DoSchedule(map<unsigned, Sched> &scheds, vector<ShopJob> &shop_jobs,
                 const ShopInfo &shopInfo,
                 Rsrc2Tintvl &mach2tintvl, Rsrc2Tintvl &opr2tintvl,
                 const vector<ShopJob *> &all_job_ptrs) {
-  map<string, OrderFptr, CaseInsensitiveLess> seqpolicydict_;
-  InitSeqPolicyDict(seqpolicydict_);
   vector<ShopJob *> shop_job_ptrs;
   ShopJobPointers(shop_job_ptrs, shop_jobs);
-  sort(shop_job_ptrs.begin(), shop_job_ptrs.end(),
-       seqpolicydict_[shopInfo.config.sequencepolicy]);
+  SortShopJobs(shop_job_ptrs, shopInfo.config.sequencepolicy);
 
   int priority = 1;
   //cerr << "total jobs = " << shop_jobs.size() << endl;
@@ -1773,6 +2044,8 @@ void PrintSchedStats(ostream &os, const SchedStats &schedStats,
   os << "Scheduling mode = Speed" << endl;
 #endif
   os << "CPU seconds = " << schedStats.cpu_sec << endl;
+  if(multiSite)
+    os << "Wall seconds = " << schedStats.wall_sec << endl;
   os << "Makespan = " << schedStats.makespan << endl;
   if(schedStats.jobs > 0) {
     tmptr = LocaltimeSafe(&schedStats.start, &tmval);
@@ -1841,7 +2114,7 @@ void PrintSchedStats(ostream &os, const SchedStats &schedStats,
   }
 }
 
-unsigned GetRsrcsQuantity(vector<string> rsrcs, Rsrc2Qty &rsrc2quantity) {
+unsigned GetRsrcsQuantity(const vector<string> &rsrcs, Rsrc2Qty &rsrc2quantity) {
   vector<string>::const_iterator r;
   unsigned quantity = 0;
 
@@ -1970,10 +2243,10 @@ void WriteScheduleEvents(vector<Job *> &rawjobs, map<unsigned, Sched> &scheds,
   map<unsigned, unsigned> stepid2seqid;
   map<unsigned, vector<unsigned> > seqid2schedids;
   //Rsrc2Qty r2q;
-  vector<Tintvl>::const_iterator t;
+  StepTintvls::const_iterator t;
   Event event;
   int quantity;
-  vector<int>::const_iterator q;
+  StepQuantities::const_iterator q;
   time_t step_start, step_end, job_end;
   vector<unsigned>::const_iterator si;
   unsigned stepid;
@@ -2035,10 +2308,12 @@ void WriteScheduleEvents(vector<Job *> &rawjobs, map<unsigned, Sched> &scheds,
           event.varsetup *= 1000;
           //event.funcseqid = machfuncseq2id[event.station];
           One2One::const_iterator seq2idItr
-            = machfuncseq2id.find(step.step.station+'-'+step.step.funcseq);
+            = machfuncseq2id.find(step.step.station.str() + '-' +
+                                  step.step.funcseq.str());
           if(seq2idItr == machfuncseq2id.end()) {
             string errmsg("Unable to find station-function sequence pair: ");
-            throw RuntimeException(errmsg + step.step.station + '-' + step.step.funcseq);
+            throw RuntimeException(errmsg + step.step.station.str() + '-' +
+                                   step.step.funcseq.str());
           }
           event.funcseqid = seq2idItr->second;
           GetDate(event.timestamp, (*t).start);
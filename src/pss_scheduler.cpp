@@ -14,9 +14,11 @@ using namespace std;
 namespace pss {
 
 Scheduler::Scheduler(const char *shop_filename, const char *job_filename,
-                     const char *sched_filename, const char *jls_filename) :
+                     const char *sched_filename, const char *jls_filename,
+                     unsigned num_threads) :
+  pool_(num_threads),
   shop_(shop_filename),
-  job_list_(job_filename, shop_.GetInfo(), 0),
+  job_list_(job_filename, shop_.GetInfo(), 0, pool_),
   sched_file_(sched_filename) {
   if(jls_filename) {
     jls_file_.open(jls_filename);
@@ -31,6 +33,9 @@ void Scheduler::Run(void) {
   vector<ShopJob *> shop_job_pointers;
   job_list_.ShopJobPointers(shop_job_pointers);
   clock_t start = clock();
+  time_t from = numeric_limits<time_t>::max(), to = numeric_limits<time_t>::min();
+  JobsHorizon(jobs, from, to);
+  shop_.PrepareCalendars(from, to);
   DoSchedule(scheds_, jobs, shop_info, mach2tintvl, opr2tintvl, shop_job_pointers);
   stats_.cpu_sec = (clock() - start) / (double) CLOCKS_PER_SEC;
   GetSchedStats(stats_, shop_job_pointers, mach2tintvl);
@@ -0,0 +1,472 @@
+/*  pss_shop_cache.cpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  implementation file for binary images of compiled shops
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+#ifdef WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include <boost/thread.hpp>
+#include "pss_shop_cache.hpp"
+#include "pss_mapped_file.hpp"
+#include "pss_exception.hpp"
+
+using namespace std;
+
+namespace pss {
+
+//must be changed whenever ShopInfo, or what GetShopInfo() puts in it,
+//changes s.t. images written before are not read
+static const boost::uint32_t kShopImageVersion = 3;
+
+static const char kShopImageMagic[8] = { 'P', 'S', 'S', 'S', 'H', 'O', 'P', '\0' };
+
+//read back as another value on a machine of the other byte order
+static const boost::uint32_t kByteOrder = 0x01020304;
+
+//scalars are written as they are in memory, their sizes being part of
+//the format of an image
+static const boost::uint32_t kScalarSizes =
+  (boost::uint32_t)(sizeof(int) | sizeof(long) << 8 | sizeof(time_t) << 16 |
+                    sizeof(size_t) << 24);
+
+struct ShopImageHeader {
+  char magic[8];
+  boost::uint32_t version;
+  boost::uint32_t byteorder;
+  boost::uint32_t scalarsizes;
+  boost::uint32_t reserved;
+  boost::uint64_t shophash;
+  boost::uint64_t size;      //size of the payload following the header
+  boost::uint64_t checksum;  //HashText() of the payload
+};
+
+boost::uint64_t HashText(const char *data, size_t size) {
+  boost::uint64_t hash = 14695981039346656037ULL;
+  for(const char *end = data + size; data < end; ++data) {
+    hash ^= (unsigned char)*data;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+string ShopImagePath(boost::uint64_t shophash) {
+  const char *dir = getenv("PSS_SHOP_CACHE_DIR");
+  if(dir == NULL || *dir == '\0')
+    return string();
+  char name[32];
+  sprintf(name, "/%016llx.pssc", (unsigned long long)shophash);
+  return dir + string(name);
+}
+
+//the payload of an image: a table of the strings of the shop, each
+//written once, followed by the shop referring to them by index
+class ImageWriter {
+ public:
+  void PutBytes(const void *data, size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+    body_.insert(body_.end(), bytes, bytes + size);
+  }
+
+  void PutString(const string &str) {
+    map<string, boost::uint32_t>::iterator it = ids_.find(str);
+    if(it == ids_.end()) {
+      it = ids_.insert(make_pair(str, (boost::uint32_t)strings_.size())).first;
+      strings_.push_back(&it->first);
+    }
+    PutBytes(&it->second, sizeof(it->second));
+  }
+
+  void GetPayload(string &payload) const {
+    payload.clear();
+    boost::uint32_t count = (boost::uint32_t)strings_.size();
+    payload.append((const char *)&count, sizeof(count));
+    for(vector<const string *>::const_iterator s = strings_.begin(); s != strings_.end(); ++s) {
+      boost::uint32_t length = (boost::uint32_t)(*s)->size();
+      payload.append((const char *)&length, sizeof(length));
+      payload.append(**s);
+    }
+    payload.append(body_.begin(), body_.end());
+  }
+
+ private:
+  vector<char> body_;
+  map<string, boost::uint32_t> ids_;
+  vector<const string *> strings_;
+};
+
+class ImageReader {
+ public:
+  //reads the string table at the start of the payload [data, end)
+  ImageReader(const char *data, const char *end) : p_(data), end_(end) {
+    boost::uint32_t count, length;
+    GetBytes(&count, sizeof(count));
+    CheckCount(count);
+    strings_.resize(count);
+    for(vector<string>::iterator s = strings_.begin(); s != strings_.end(); ++s) {
+      GetBytes(&length, sizeof(length));
+      CheckCount(length);
+      s->assign(p_, length);
+      p_ += length;
+    }
+  }
+
+  void GetBytes(void *data, size_t size) {
+    CheckCount(size);
+    memcpy(data, p_, size);
+    p_ += size;
+  }
+
+  const string &GetString(void) {
+    boost::uint32_t id;
+    GetBytes(&id, sizeof(id));
+    if(id >= strings_.size())
+      throw RuntimeException("Invalid string in shop image");
+    return strings_[id];
+  }
+
+  //each item written takes a byte at least
+  void CheckCount(boost::uint64_t count) const {
+    if(count > (boost::uint64_t)(end_ - p_))
+      throw RuntimeException("Truncated shop image");
+  }
+
+  bool AtEnd(void) const {
+    return p_ == end_;
+  }
+
+ private:
+  const char *p_;
+  const char *end_;
+  vector<string> strings_;
+};
+
+//Item() writes or reads one item of an image, structs being transferred
+//field by field with the same Transfer() in both directions
+
+template<typename T>
+static typename enable_if<is_arithmetic<T>::value>::type
+Item(ImageWriter &w, const T &value) {
+  w.PutBytes(&value, sizeof(value));
+}
+
+template<typename T>
+static typename enable_if<is_arithmetic<T>::value>::type
+Item(ImageReader &r, T &value) {
+  r.GetBytes(&value, sizeof(value));
+}
+
+static void Item(ImageWriter &w, const CalendarKind &kind) {
+  Item(w, (int)kind);
+}
+
+static void Item(ImageReader &r, CalendarKind &kind) {
+  int value;
+  Item(r, value);
+  kind = (CalendarKind)value;
+}
+
+static void Item(ImageWriter &w, const string &str) {
+  w.PutString(str);
+}
+
+static void Item(ImageReader &r, string &str) {
+  str = r.GetString();
+}
+
+static void Item(ImageWriter &w, const Symbol &symbol) {
+  w.PutString(symbol.str());
+}
+
+static void Item(ImageReader &r, Symbol &symbol) {
+  symbol = Symbol(r.GetString());
+}
+
+template<size_t N>
+static void Item(ImageWriter &w, const bitset<N> &bits) {
+  for(size_t i = 0; i < N; i += 32) {
+    boost::uint32_t word = 0;
+    for(size_t b = i; b < N && b < i + 32; ++b)
+      word |= (boost::uint32_t)bits[b] << (b - i);
+    Item(w, word);
+  }
+}
+
+template<size_t N>
+static void Item(ImageReader &r, bitset<N> &bits) {
+  for(size_t i = 0; i < N; i += 32) {
+    boost::uint32_t word;
+    Item(r, word);
+    for(size_t b = i; b < N && b < i + 32; ++b)
+      bits[b] = (word >> (b - i)) & 1;
+  }
+}
+
+template<typename T>
+static typename enable_if<is_class<T>::value>::type
+Item(ImageWriter &w, const T &value);
+
+template<typename T>
+static typename enable_if<is_class<T>::value>::type
+Item(ImageReader &r, T &value);
+
+template<typename T, typename A>
+static void Item(ImageWriter &w, const vector<T, A> &v) {
+  Item(w, (boost::uint64_t)v.size());
+  for(typename vector<T, A>::const_iterator it = v.begin(); it != v.end(); ++it)
+    Item(w, *it);
+}
+
+template<typename T, typename A>
+static void Item(ImageReader &r, vector<T, A> &v) {
+  boost::uint64_t size;
+  Item(r, size);
+  r.CheckCount(size);
+  v.resize((size_t)size);
+  for(typename vector<T, A>::iterator it = v.begin(); it != v.end(); ++it)
+    Item(r, *it);
+}
+
+template<typename T, typename C, typename A>
+static void Item(ImageWriter &w, const set<T, C, A> &s) {
+  Item(w, (boost::uint64_t)s.size());
+  for(typename set<T, C, A>::const_iterator it = s.begin(); it != s.end(); ++it)
+    Item(w, *it);
+}
+
+template<typename T, typename C, typename A>
+static void Item(ImageReader &r, set<T, C, A> &s) {
+  boost::uint64_t size;
+  Item(r, size);
+  r.CheckCount(size);
+  for(s.clear(); size > 0; --size) {
+    T value = T();
+    Item(r, value);
+    //written in order
+    s.insert(s.end(), value);
+  }
+}
+
+template<typename K, typename V, typename C, typename A>
+static void Item(ImageWriter &w, const map<K, V, C, A> &m) {
+  Item(w, (boost::uint64_t)m.size());
+  for(typename map<K, V, C, A>::const_iterator it = m.begin(); it != m.end(); ++it) {
+    Item(w, it->first);
+    Item(w, it->second);
+  }
+}
+
+template<typename K, typename V, typename C, typename A>
+static void Item(ImageReader &r, map<K, V, C, A> &m) {
+  boost::uint64_t size;
+  Item(r, size);
+  r.CheckCount(size);
+  for(m.clear(); size > 0; --size) {
+    K key;
+    Item(r, key);
+    //written in order
+    Item(r, m.insert(m.end(), make_pair(key, V()))->second);
+  }
+}
+
+template<typename Archive>
+static void Transfer(Archive &ar, Tintvl &tintvl) {
+  Item(ar, tintvl.intid);
+  Item(ar, tintvl.seqid);
+  Item(ar, tintvl.start);
+  Item(ar, tintvl.end);
+}
+
+template<typename Archive>
+static void Transfer(Archive &ar, DayIndex &index) {
+  Item(ar, index.keys);
+  Item(ar, index.firsts);
+  Item(ar, index.slots);
+}
+
+template<typename Archive>
+static void Transfer(Archive &ar, DayTs &dayts) {
+  Item(ar, dayts.once);
+  Item(ar, dayts.everyyear);
+  Item(ar, dayts.yeardays);
+}
+
+template<typename Archive>
+static void Transfer(Archive &ar, Calendar &calendar) {
+  Item(ar, calendar.weekts);
+  Item(ar, calendar.dayts);
+  Item(ar, calendar.kind);
+}
+
+//fields the scheduler never reads (and kParseForScheduling skips) are left
+//out of images throughout, being read back as 0 from value-initialized items
+template<typename Archive>
+static void Transfer(Archive &ar, FuncInfo &funcinfo) {
+  Item(ar, funcinfo.name);
+  Item(ar, funcinfo.oprdemand);
+  Item(ar, funcinfo.setuptime);
+  Item(ar, funcinfo.speedval);
+  Item(ar, funcinfo.speedunit);
+  Item(ar, funcinfo.timeunit);
+  Item(ar, funcinfo.minbatch);
+  Item(ar, funcinfo.barcode);
+}
+
+template<typename Archive>
+static void Transfer(Archive &ar, SimpleFunc &simplefunc) {
+  Item(ar, simplefunc.funcinfo);
+  Item(ar, simplefunc.names);
+  Item(ar, simplefunc.attributes);
+}
+
+template<typename Archive>
+static void Transfer(Archive &ar, Sfunc &sfunc) {
+  Item(ar, sfunc.station);
+  Item(ar, sfunc.funcseq);
+}
+
+template<typename Archive>
+static void Transfer(Archive &ar, SeqCells &seqcells) {
+  Item(ar, seqcells.funcseq);
+  Item(ar, seqcells.cells);
+}
+
+template<typename Archive>
+static void Transfer(Archive &ar, CellConfig &cellconfig) {
+  Item(ar, cellconfig.batching);
+  Item(ar, cellconfig.oprlimited);
+  Item(ar, cellconfig.useoprskills);
+  Item(ar, cellconfig.useoprschds);
+}
+
+template<typename Archive>
+static void Transfer(Archive &ar, Config &config) {
+  Item(ar, config.cellpolicy);
+  Item(ar, config.sequencepolicy);
+  Item(ar, config.batchlimit);
+  Item(ar, config.routingpolicy);
+  Item(ar, config.threshold);
+  Item(ar, config.funcname);
+}
+
+//the local time table and the calendar bitmaps are left out, being built
+//for the horizon of the jobs scheduled (see Shop::PrepareCalendars())
+template<typename Archive>
+static void Transfer(Archive &ar, ShopInfo &shop_info) {
+  Item(ar, shop_info.seq2mach);
+  Item(ar, shop_info.calendars);
+  Item(ar, shop_info.mach2cal);
+  Item(ar, shop_info.station2seq);
+  Item(ar, shop_info.cell2opr);
+  Item(ar, shop_info.seq2opr);
+  Item(ar, shop_info.opr2cal);
+  Item(ar, shop_info.cell2config);
+  Item(ar, shop_info.unit2minbatch);
+  Item(ar, shop_info.rsrc2speed);
+  Item(ar, shop_info.func2seq);
+  Item(ar, shop_info.seq2func);
+  Item(ar, shop_info.func2sameseqfunc);
+  Item(ar, shop_info.machfuncseq2id);
+  Item(ar, shop_info.seq2cell);
+  Item(ar, shop_info.config);
+}
+
+template<typename T>
+static typename enable_if<is_class<T>::value>::type
+Item(ImageWriter &w, const T &value) {
+  //Transfer() only reads 'value' when writing
+  Transfer(w, const_cast<T &>(value));
+}
+
+template<typename T>
+static typename enable_if<is_class<T>::value>::type
+Item(ImageReader &r, T &value) {
+  Transfer(r, value);
+}
+
+bool LoadShopImage(ShopInfo &shop_info, const string &path,
+                   boost::uint64_t shophash) {
+  try {
+    MappedFile image(path.c_str());
+    ShopImageHeader header;
+    if(image.size() < sizeof(header))
+      return false;
+    memcpy(&header, image.data(), sizeof(header));
+    if(memcmp(header.magic, kShopImageMagic, sizeof(header.magic)) != 0 ||
+        header.version != kShopImageVersion || header.byteorder != kByteOrder ||
+        header.scalarsizes != kScalarSizes || header.shophash != shophash ||
+        header.size != image.size() - sizeof(header))
+      return false;
+    const char *payload = image.data() + sizeof(header);
+    if(HashText(payload, (size_t)header.size) != header.checksum)
+      return false;
+    ImageReader reader(payload, payload + header.size);
+    ShopInfo loaded;
+    Item(reader, loaded);
+    if(!reader.AtEnd())
+      return false;
+    swap(shop_info, loaded);
+    return true;
+  } catch(RuntimeException &) {
+    return false;
+  }
+}
+
+static long ProcessId(void) {
+#ifdef WIN32
+  return (long)_getpid();
+#else
+  return (long)getpid();
+#endif
+}
+
+bool SaveShopImage(const ShopInfo &shop_info, const string &path,
+                   boost::uint64_t shophash) {
+  ImageWriter writer;
+  Item(writer, shop_info);
+  string payload;
+  writer.GetPayload(payload);
+  ShopImageHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kShopImageMagic, sizeof(header.magic));
+  header.version = kShopImageVersion;
+  header.byteorder = kByteOrder;
+  header.scalarsizes = kScalarSizes;
+  header.shophash = shophash;
+  header.size = payload.size();
+  header.checksum = HashText(payload.data(), payload.size());
+  //written aside and renamed over 'path', which is atomic; the name written
+  //to is unique to the process and thread, as other processes may be
+  //saving the same image
+  stringstream ss;
+  ss << path << '.' << ProcessId() << '.' << boost::this_thread::get_id()
+     << ".tmp";
+  string tmppath = ss.str();
+  {
+    ofstream os(tmppath.c_str(), ios::out | ios::binary | ios::trunc);
+    os.write((const char *)&header, sizeof(header));
+    os.write(payload.data(), payload.size());
+    os.close();
+    if(!os) {
+      remove(tmppath.c_str());
+      return false;
+    }
+  }
+  if(rename(tmppath.c_str(), path.c_str()) != 0) {
+    remove(tmppath.c_str());
+    return false;
+  }
+  return true;
+}
+
+} // namespace pss
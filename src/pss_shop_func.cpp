@@ -5,6 +5,7 @@
  *
  *  implementation file for pss shop functions
  */
+#include <assert.h>
 #include <sstream>
 #include <algorithm>
 #include "pss_shop_func.hpp"
@@ -48,6 +49,50 @@ void SimpleFuncInSeconds(SimpleFunc &simplefunc) {
   AttributesInSeconds(simplefunc.attributes);
 }
 
+//calendars are told apart by their time slots alone
+static void CalendarContent(vector<time_t> &content, const TintvlVec2d &weekts,
+                            const DayTs &dayts) {
+  const DayIndex *days[] = { &dayts.once, &dayts.everyyear };
+
+  content.clear();
+  for(TintvlVec2d::const_iterator w = weekts.begin(); w != weekts.end(); ++w) {
+    content.push_back((time_t)w->size());
+    for(vector<Tintvl>::const_iterator t = w->begin(); t != w->end(); ++t) {
+      content.push_back(t->start);
+      content.push_back(t->end);
+    }
+  }
+  for(unsigned d = 0; d < 2; ++d) {
+    content.push_back((time_t)days[d]->keys.size());
+    content.insert(content.end(), days[d]->keys.begin(), days[d]->keys.end());
+    content.insert(content.end(), days[d]->firsts.begin(), days[d]->firsts.end());
+    for(vector<Tintvl>::const_iterator t = days[d]->slots.begin();
+        t != days[d]->slots.end(); ++t) {
+      content.push_back(t->start);
+      content.push_back(t->end);
+    }
+  }
+}
+
+//returns the id of the calendar in 'shop_info' with the given time slots,
+//adding one if there is none yet
+static CalendarId InternCalendar(ShopInfo &shop_info,
+                                 map<vector<time_t>, CalendarId> &interned,
+                                 const TintvlVec2d &weekts, const DayTs &dayts) {
+  vector<time_t> content;
+
+  CalendarContent(content, weekts, dayts);
+  map<vector<time_t>, CalendarId>::const_iterator c = interned.find(content);
+  if(c != interned.end())
+    return c->second;
+  Calendar calendar;
+  calendar.weekts = weekts;
+  calendar.dayts = dayts;
+  calendar.kind = GetCalendarKind(weekts, dayts);
+  shop_info.calendars.push_back(calendar);
+  return interned[content] = shop_info.calendars.size() - 1;
+}
+
 void GetShopInfo(ShopInfo &shop_info, ShopModel &shop) {
   vector<Cell>::const_iterator c;
   vector<Station>::const_iterator i;
@@ -61,6 +106,8 @@ void GetShopInfo(ShopInfo &shop_info, ShopModel &shop) {
   Seq2Sfunc::const_iterator m;
   TintvlVec2d shopweekts, machweekts, oprweekts;
   DayTs shopdayts, machdayts, oprdayts;
+  map<vector<time_t>, CalendarId> interned;
+  CalendarId shop_cal;
 
   shop_info.config = shop.config;
   for(i = shop.stations.begin(); i != shop.stations.end(); ++i)
@@ -85,39 +132,34 @@ void GetShopInfo(ShopInfo &shop_info, ShopModel &shop) {
     }
   }
   GetTmslot(shopweekts, shopdayts, shop.schds);
+  shop_info.calendars.clear();
+  shop_cal = InternCalendar(shop_info, interned, shopweekts, shopdayts);
   for(o = shop.operators.begin(); o != shop.operators.end(); ++o) {
     opr2skills[(*o).baseinfo.name].insert((*o).skills.begin(), (*o).skills.end());
     if(!(*o).schds.empty()) {
       oprweekts.clear();
-      oprdayts.once.clear();
-      oprdayts.everyyear.clear();
+      oprdayts.clear();
       GetTmslot(oprweekts, oprdayts, (*o).schds);
-      shop_info.opr2weekts[(*o).baseinfo.name] = oprweekts;
-      shop_info.opr2dayts[(*o).baseinfo.name] = oprdayts;
-    } else {
-      shop_info.opr2weekts[(*o).baseinfo.name] = shopweekts;
-      shop_info.opr2dayts[(*o).baseinfo.name] = shopdayts;
-    }
+      shop_info.opr2cal[(*o).baseinfo.name] =
+        InternCalendar(shop_info, interned, oprweekts, oprdayts);
+    } else
+      shop_info.opr2cal[(*o).baseinfo.name] = shop_cal;
   }
   //add a special operator "any" that is always available 24/7
   //useful when scheduling is not limited by operators
   GetTmslot247(oprweekts, oprdayts);
-  shop_info.opr2weekts["any"] = oprweekts;
-  shop_info.opr2dayts["any"] = oprdayts;
+  shop_info.opr2cal["any"] = InternCalendar(shop_info, interned, oprweekts, oprdayts);
   for(i = shop.stations.begin(); i != shop.stations.end(); ++i) {
     sfunc.station = (*i).baseinfo.name;
     //cout << "baseinfo.name = " << (*i).baseinfo.name << endl;
     if(!(*i).schds.empty()) {
       machweekts.clear();
-      machdayts.once.clear();
-      machdayts.everyyear.clear();
+      machdayts.clear();
       GetTmslot(machweekts, machdayts, (*i).schds);
-      shop_info.mach2weekts[(*i).baseinfo.name] = machweekts;
-      shop_info.mach2dayts[(*i).baseinfo.name] = machdayts;
-    } else {
-      shop_info.mach2weekts[(*i).baseinfo.name] = shopweekts;
-      shop_info.mach2dayts[(*i).baseinfo.name] = shopdayts;
-    }
+      shop_info.mach2cal[(*i).baseinfo.name] =
+        InternCalendar(shop_info, interned, machweekts, machdayts);
+    } else
+      shop_info.mach2cal[(*i).baseinfo.name] = shop_cal;
     map<string, SimpleFunc> name2seq;
     for(j = (*i).simplefuncs.begin(); j != (*i).simplefuncs.end(); ++j) {
       string funcseq = (*j).funcinfo.name;
@@ -137,22 +179,25 @@ void GetShopInfo(ShopInfo &shop_info, ShopModel &shop) {
         for(k = funcnames.begin(); k != funcnames.end(); ++k)  {
           set<string> &funcset = shop_info.seq2func[funcseq];
           if(funcset.find(*k) == funcset.end()) {
-            throw RuntimeException("Station: " + sfunc.station +
+            throw RuntimeException("Station: " + sfunc.station.str() +
                                    "\n\tFunction step '" + *k
                                    + "' not found in previously defined sequence: "
                                    + funcseq);
           }
         }
       }
-      if(mach2cell[sfunc.station] != "")
-        shop_info.seq2cell[funcseq].insert(mach2cell[sfunc.station]);
+      if(mach2cell[sfunc.station] != "") {
+        SeqCells &seqcells = shop_info.seq2cell[funcseq];
+        seqcells.funcseq = funcseq;
+        seqcells.cells.insert(mach2cell[sfunc.station]);
+      }
       stringstream sstr;
       sstr << (*i).stationinfo.barcode << '-' << (*j).funcinfo.barcode;
-      shop_info.machfuncseq2id[sfunc.station+'-'+funcseq] = sstr.str();
+      shop_info.machfuncseq2id[sfunc.station.str()+'-'+funcseq] = sstr.str();
       sfunc.funcseq = *j;
       SimpleFuncInSeconds(sfunc.funcseq);
       if(sfunc.funcseq.funcinfo.speedval <= 0.0) {
-        throw RuntimeException("Station: " + sfunc.station +
+        throw RuntimeException("Station: " + sfunc.station.str() +
                                "\n\tSpeed value must be greater than zero: " +
                                (*j).funcinfo.name);
       }
@@ -167,8 +212,8 @@ void GetShopInfo(ShopInfo &shop_info, ShopModel &shop) {
           = minbatch;
       if(mach2cell[sfunc.station] != "") {
         shop_info.seq2mach[mach2cell[sfunc.station]][funcseq].insert(sfunc);
-        set<string> &coprs = shop_info.cell2opr[mach2cell[sfunc.station]];
-        set<string>::const_iterator copr;
+        SymbolSet &coprs = shop_info.cell2opr[mach2cell[sfunc.station]];
+        SymbolSet::const_iterator copr;
         for(copr = coprs.begin(); copr != coprs.end(); ++copr) {
           set<string> &skills = opr2skills[*copr];
           if(includes(skills.begin(), skills.end(),
@@ -320,6 +365,64 @@ void OnOffMessage(string &message, enum OnOff code) {
   }
 }
 
+//jobs usually finish within a few weeks past [from, to];
+//the bitmaps never cover more than a year
+void BuildCalendarBitmaps(ShopInfo &shop_info, time_t from, time_t to) {
+  const time_t week = 7 * 86400;
+
+  shop_info.calbits.clear();
+  shop_info.calpair2bits.clear();
+  if(from > to)
+    return;
+  to = min(to + 4 * week, from + 366 * 86400);
+  //station and operator calendars that can go together, one pair at a time
+  set<pair<CalendarId, CalendarId> > calpairs;
+  map<string, CellConfig>::const_iterator c;
+  for(c = shop_info.cell2config.begin(); c != shop_info.cell2config.end(); ++c) {
+    map<string, Seq2Sfunc>::const_iterator s2m = shop_info.seq2mach.find(c->first);
+    map<string, One2Symbols>::const_iterator s2o = shop_info.seq2opr.find(c->first);
+    if(!c->second.useoprschds || s2m == shop_info.seq2mach.end() ||
+       s2o == shop_info.seq2opr.end())
+      continue;
+    for(Seq2Sfunc::const_iterator f = s2m->second.begin(); f != s2m->second.end(); ++f) {
+      One2Symbols::const_iterator oprs = s2o->second.find(f->first);
+      if(oprs == s2o->second.end())
+        continue;
+      for(SfuncSet::const_iterator s = f->second.begin(); s != f->second.end(); ++s) {
+        map<string, CalendarId>::const_iterator mc = shop_info.mach2cal.find(s->station);
+        if(mc == shop_info.mach2cal.end())
+          continue;
+        for(SymbolSet::const_iterator o = oprs->second.begin();
+            o != oprs->second.end(); ++o) {
+          map<string, CalendarId>::const_iterator oc = shop_info.opr2cal.find(*o);
+          if(oc != shop_info.opr2cal.end())
+            calpairs.insert(make_pair(mc->second, oc->second));
+        }
+      }
+    }
+  }
+  //bitmaps of station calendars and of the operator calendars above,
+  //each built only once
+  shop_info.calbits.resize(shop_info.calendars.size());
+  vector<bool> needed(shop_info.calendars.size(), false);
+  map<string, CalendarId>::const_iterator m;
+  for(m = shop_info.mach2cal.begin(); m != shop_info.mach2cal.end(); ++m)
+    needed[m->second] = true;
+  set<pair<CalendarId, CalendarId> >::const_iterator p;
+  for(p = calpairs.begin(); p != calpairs.end(); ++p)
+    needed[p->second] = true;
+  for(CalendarId id = 0; id < needed.size(); ++id) {
+    const Calendar &calendar = shop_info.calendars[id];
+    if(needed[id])
+      shop_info.calbits[id].Build(from, to, calendar.weekts, calendar.dayts,
+                                  shop_info.localtime);
+  }
+  for(p = calpairs.begin(); p != calpairs.end(); ++p) {
+    shop_info.calpair2bits[*p].Intersect(shop_info.calbits[p->first],
+                                         shop_info.calbits[p->second]);
+  }
+}
+
 void PrintShopConfig(ostream &os, const ShopInfo &shop_info) {
   string on_off_msg;
 
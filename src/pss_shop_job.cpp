@@ -19,8 +19,8 @@ namespace pss {
 //typedef vector<Step>::size_type StepId;
 typedef unsigned StepId;
 
-bool MatchInOutRsrcs(vector<string> outputs,
-                     vector<string> inputs) {
+bool MatchInOutRsrcs(const vector<string> &outputs,
+                     const vector<string> &inputs) {
   vector<string>::const_iterator rin, rout;
 
   for(rin = inputs.begin(); rin != inputs.end(); ++rin) {
@@ -222,18 +222,4 @@ void GetShopJob(ShopJob &shop_job, const Job &job, const ShopInfo &shop_info,
     shop_job.funcseqs.push_back(funcseq);
   }
 }
-
-void GetShopJobs(vector<ShopJob> &shop_jobs, const vector<Job> &jobs,
-                 const ShopInfo &shop_info, const unsigned min_job_int_id) {
-  vector<ShopJob>::iterator sj;
-  vector<Job>::const_iterator j;
-  shop_jobs.resize(jobs.size());
-  unsigned job_int_id; //job internal id
-
-  for(sj = shop_jobs.begin(), j = jobs.begin(), job_int_id = min_job_int_id;
-      j != jobs.end();
-      ++sj, ++j, ++job_int_id) {
-    GetShopJob(*sj, *j, shop_info, job_int_id);
-  }
-}
 } // namespace pss
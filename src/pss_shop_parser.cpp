@@ -5,7 +5,6 @@
  *
  *  implementation file pss shop parser
  */
-#include <fstream>
 #include "pss_shop_parser.hpp"
 #include "pss_parser_utils.hpp"
 
@@ -14,31 +13,44 @@ using namespace rapidxml;
 
 namespace pss {
 //Helper function
-void ParseStationInfo(xml_node<> *node, StationInfo &stationinfo) {
+void ParseStationInfo(xml_node<> *node, StationInfo &stationinfo,
+                      ParseProfile profile) {
   ParseAttr<int>(node, "Barcode", stationinfo.barcode);
   ParseStrAttr(node, "StationID", stationinfo.stationid);
-  ParseBoolAttr(node, "HighCapacity", stationinfo.highcapacity);
-  ParseAttr<double>(node, "mttf", stationinfo.mttf);
-  ParseAttr<double>(node, "mttr", stationinfo.mttr);
+  if(profile == kParseAll) {
+    ParseBoolAttr(node, "HighCapacity", stationinfo.highcapacity);
+    ParseAttr<double>(node, "mttf", stationinfo.mttf);
+    ParseAttr<double>(node, "mttr", stationinfo.mttr);
+  } else {
+    stationinfo.highcapacity = false;
+    stationinfo.mttf = stationinfo.mttr = 0;
+  }
 }
 
 //Helper function
-void ParseFuncInfo(xml_node<> *node, FuncInfo &funcinfo) {
+void ParseFuncInfo(xml_node<> *node, FuncInfo &funcinfo, ParseProfile profile) {
   ParseStrAttr(node, "Name", funcinfo.name);
   ParseAttr<double>(node, "OperatorDemand", funcinfo.oprdemand);
   ParseAttr<double>(node, "SetupTime", funcinfo.setuptime);
   ParseAttr<double>(node, "SpeedValue", funcinfo.speedval);
   ParseStrAttr(node, "SpeedUnit", funcinfo.speedunit);
-  ParseAttr<double>(node, "SpeedVariation", funcinfo.speedvar);
+  if(profile == kParseAll)
+    ParseAttr<double>(node, "SpeedVariation", funcinfo.speedvar);
+  else
+    funcinfo.speedvar = 0;
   ParseStrAttr(node, "TimeUnit", funcinfo.timeunit);
-  ParseAttr<int>(node, "Quality", funcinfo.quality);
+  if(profile == kParseAll)
+    ParseAttr<int>(node, "Quality", funcinfo.quality);
+  else
+    funcinfo.quality = 0;
   ParseAttr<int>(node, "MinBatch", funcinfo.minbatch);
   ParseAttr<int>(node, "Barcode", funcinfo.barcode);
 }
 
 //Helper function
-void ParseSimpleFunc(xml_node<> *node, SimpleFunc &simplefunc) {
-  ParseFuncInfo(node, simplefunc.funcinfo);
+void ParseSimpleFunc(xml_node<> *node, SimpleFunc &simplefunc,
+                     ParseProfile profile) {
+  ParseFuncInfo(node, simplefunc.funcinfo, profile);
   //Parse SimpleFunctions
   ParseVector<string>(node, "SimpleFunction", simplefunc.names, ParseNameAttr);
   xml_node<> *attrs = node->first_node("Attributes");
@@ -54,15 +66,20 @@ void ParseSimpleFunc(xml_node<> *node, SimpleFunc &simplefunc) {
 }
 
 //Helper function
-void ParseStation(xml_node<> *node, Station &station) {
+void ParseStation(xml_node<> *node, Station &station, ParseProfile profile) {
   ParseBaseInfo(node, station.baseinfo);
-  ParseStationInfo(node, station.stationinfo);
-  xml_node<> *geometry = node->first_node("Geometry");
-  ParseGeometry(geometry, station.geometry);
+  ParseStationInfo(node, station.stationinfo, profile);
+  if(profile == kParseAll) {
+    xml_node<> *geometry = node->first_node("Geometry");
+    ParseGeometry(geometry, station.geometry);
+  } else
+    station.geometry = Geometry();
   ParseSchedule(node, station.schds);
   //Parse SimpleFunctionSequences
   ParseVector<SimpleFunc>(node, "SimpleFunctionSequence", station.simplefuncs,
-                          ParseSimpleFunc);
+                          [profile](xml_node<> *n, SimpleFunc &simplefunc) {
+                            ParseSimpleFunc(n, simplefunc, profile);
+                          });
 }
 
 //Helper function
@@ -81,11 +98,16 @@ void ParseOperator(xml_node<> *node, Opr &opr) {
 }
 
 //Helper function
-void ParseConfig(xml_node<> *node, Config &config) {
+void ParseConfig(xml_node<> *node, Config &config, ParseProfile profile) {
   assert(node);
   xml_node<> *cfgnode = node->first_node("ShopConfiguration");
   assert(cfgnode);
-  ParseStrAttr(cfgnode, "CellAssignmentPolicy", config.cellpolicy);
+  //attributes missing (e.g. Threshold) are left 0 or empty
+  config = Config();
+  if(profile == kParseAll)
+    ParseStrAttr(cfgnode, "CellAssignmentPolicy", config.cellpolicy);
+  else
+    config.cellpolicy.clear();
   ParseStrAttr(cfgnode, "SequencingPolicy", config.sequencepolicy);
   ParseAttr<int>(cfgnode, "BatchLimit", config.batchlimit);
   ParseStrAttr(cfgnode, "RoutingPolicy", config.routingpolicy);
@@ -94,12 +116,16 @@ void ParseConfig(xml_node<> *node, Config &config) {
 }
 
 //Helper function
-void ParseCellConfig(xml_node<> *node, CellConfig &cellconfig) {
+void ParseCellConfig(xml_node<> *node, CellConfig &cellconfig,
+                     ParseProfile profile) {
   assert(node);
   xml_node<> *cfgnode = node->first_node("CellConfiguration");
   assert(cfgnode);
-  ParseAttr<int>(cfgnode, "ControlPolicy", cellconfig.policy);
-  ParseAttr<int>(cfgnode, "ControlParameter", cellconfig.parameter);
+  if(profile == kParseAll) {
+    ParseAttr<int>(cfgnode, "ControlPolicy", cellconfig.policy);
+    ParseAttr<int>(cfgnode, "ControlParameter", cellconfig.parameter);
+  } else
+    cellconfig.policy = cellconfig.parameter = 0;
   ParseBoolAttr(cfgnode, "Batching", cellconfig.batching);
   ParseBoolAttr(cfgnode, "OperatorLimited", cellconfig.oprlimited);
   ParseBoolAttr(cfgnode, "UseOperatorSkills", cellconfig.useoprskills);
@@ -125,39 +151,48 @@ void ParseCellOperators(xml_node<> *node, vector<string> &operators) {
 }
 
 //Helper function
-void ParseCell(xml_node<> *node, Cell &cell) {
+void ParseCell(xml_node<> *node, Cell &cell, ParseProfile profile) {
   assert(node);
-  ParseStrAttr(node, "CellId", cell.cellid);
+  if(profile == kParseAll)
+    ParseStrAttr(node, "CellId", cell.cellid);
+  else
+    cell.cellid.clear();
   ParseBaseInfo(node, cell.baseinfo);
-  ParseCellConfig(node, cell.cellconfig);
+  ParseCellConfig(node, cell.cellconfig, profile);
   ParseCellStations(node, cell.stations);
   ParseCellOperators(node, cell.operators);
 }
 
 int ShopParser::ParseFile(char const *path) {
-  ifstream file(path);
-  //read the entire file into buf
-  std::vector<char> buf((istreambuf_iterator<char>(file)),
-                        istreambuf_iterator<char>());
-  buf.push_back('\0');
+  return ParseFile(boost::shared_ptr<const MappedFile>(new MappedFile(path)));
+}
+
+int ShopParser::ParseFile(const boost::shared_ptr<const MappedFile> &source) {
+  shopmodel_.source = source;
   xml_document<> doc;
-  //Parse the string pointed to by 'buf'
-  doc.parse<0>(&buf[0]);
+  //Parse the mapped file in place
+  ParseXmlFile(doc, *shopmodel_.source);
   //Obtain the shop node
   xml_node<> *shpnode = doc.first_node("Shop");
   ParseBaseInfo(shpnode, shopmodel_.baseinfo);
   ParseStrAttr(shpnode, "Creator", shopmodel_.creator);
   ParseStrAttr(shpnode, "Version", shopmodel_.version);
   //Parse shop configuration
-  ParseConfig(shpnode, shopmodel_.config);
+  ParseConfig(shpnode, shopmodel_.config, profile_);
   //Parse schedule
   ParseSchedule(shpnode, shopmodel_.schds);
   //Parse stations
-  ParseVector<Station>(shpnode, "Station", shopmodel_.stations, ParseStation);
+  ParseVector<Station>(shpnode, "Station", shopmodel_.stations,
+                       [this](xml_node<> *n, Station &station) {
+                         ParseStation(n, station, profile_);
+                       });
   //Parse operators
   ParseVector<Opr>(shpnode, "Operator", shopmodel_.operators, ParseOperator);
   //Parse cells
-  ParseVector<Cell>(shpnode, "Cell", shopmodel_.cells, ParseCell);
+  ParseVector<Cell>(shpnode, "Cell", shopmodel_.cells,
+                    [this](xml_node<> *n, Cell &cell) {
+                      ParseCell(n, cell, profile_);
+                    });
   return 0;
 }
 
@@ -0,0 +1,31 @@
+/*  pss_symbol.cpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  interned strings for the names of schedule steps
+ */
+
+#include <set>
+#include <boost/thread/mutex.hpp>
+#include "pss_symbol.hpp"
+
+using namespace std;
+
+namespace pss {
+
+const string *Symbol::Intern(const string &str) {
+  //never destroyed s.t. symbols stay valid during static destruction
+  static set<string> *pool = new set<string>;
+  static boost::mutex *pool_mutex = new boost::mutex;
+  boost::mutex::scoped_lock lock(*pool_mutex);
+
+  return &*pool->insert(str).first;
+}
+
+const string *Symbol::Empty(void) {
+  static const string *empty = Intern(string());
+
+  return empty;
+}
+
+} // namespace pss
@@ -0,0 +1,111 @@
+/*  pss_task_pool.cpp
+ *
+ *  Copyright 2016 Palo Alto Research Center Inc. All rights reserved.
+ *
+ *  implementation file for the task pool
+ */
+
+#include <assert.h>
+#include <ctime>
+#include "pss_task_pool.hpp"
+
+using namespace std;
+
+namespace pss {
+
+TaskPool::TaskPool(unsigned num_threads) :
+  batch_(NULL), next_(0), unfinished_(0), batch_id_(0), error_task_(0), stop_(false) {
+  for(unsigned t = 1; t < num_threads; ++t)
+    workers_.push_back(new boost::thread([this] { Work(); }));
+}
+
+TaskPool::~TaskPool() {
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    stop_ = true;
+  }
+  batch_ready_.notify_all();
+  for(vector<boost::thread *>::iterator it = workers_.begin(); it != workers_.end(); ++it) {
+    (*it)->join();
+    delete *it;
+  }
+}
+
+void TaskPool::RunTasks(boost::mutex::scoped_lock &lock) {
+  vector<Task> &tasks = *batch_;
+  while(next_ < tasks.size()) {
+    size_t t = next_++;
+    lock.unlock();
+    try {
+      tasks[t]();
+    } catch(...) {
+      lock.lock();
+      if(!error_ || t < error_task_) {
+        error_ = current_exception();
+        error_task_ = t;
+      }
+      lock.unlock();
+    }
+    lock.lock();
+    if(--unfinished_ == 0)
+      batch_done_.notify_all();
+  }
+}
+
+void TaskPool::Work(void) {
+  unsigned last_batch_id = 0;
+  boost::mutex::scoped_lock lock(mutex_);
+  for(;;) {
+    while(!stop_ && (batch_ == NULL || batch_id_ == last_batch_id))
+      batch_ready_.wait(lock);
+    if(stop_)
+      return;
+    last_batch_id = batch_id_;
+    RunTasks(lock);
+  }
+}
+
+void TaskPool::Run(vector<Task> &tasks) {
+  if(tasks.empty())
+    return;
+  boost::mutex::scoped_lock lock(mutex_);
+  assert(batch_ == NULL);
+  batch_ = &tasks;
+  next_ = 0;
+  unfinished_ = tasks.size();
+  ++batch_id_;
+  error_ = exception_ptr();
+  if(!workers_.empty() && tasks.size() > 1)
+    batch_ready_.notify_all();
+  RunTasks(lock);
+  while(unfinished_ > 0)
+    batch_done_.wait(lock);
+  batch_ = NULL;
+  if(error_) {
+    exception_ptr error = error_;
+    error_ = exception_ptr();
+    rethrow_exception(error);
+  }
+}
+
+double ThreadCpuSeconds(void) {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+  return clock() / (double)CLOCKS_PER_SEC; //process-wide
+#endif
+}
+
+double WallSeconds(void) {
+#ifdef CLOCK_MONOTONIC
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+  return (double)time(NULL);
+#endif
+}
+
+} // namespace pss
@@ -66,6 +66,114 @@ tm *LocaltimeSafe(const time_t *timep, tm *result) {
   return result;
 }
 
+//days since 1970-01-01 of the given (proleptic Gregorian) date
+static long DaysFromCivil(long y, const unsigned m, const unsigned d) {
+  y -= m <= 2;
+  const long era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = (unsigned)(y - era * 400);
+  const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (long)doe - 719468;
+}
+
+//inverse of DaysFromCivil(); 'm' is 1 - 12
+static void CivilFromDays(long z, long &y, unsigned &m, unsigned &d) {
+  z += 719468;
+  const long era = (z >= 0 ? z : z - 146096) / 146097;
+  const unsigned doe = (unsigned)(z - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = (long)yoe + era * 400 + (m <= 2);
+}
+
+static inline long FloorDiv(const time_t a, const long b) {
+  return (long)(a >= 0 ? a / b : -((-a + b - 1) / b));
+}
+
+//offset of local time from UTC at "time", as applied by localtime_r()
+static time_t UtcOffset(const time_t time) {
+  tm tm, *when;
+
+  when = LocaltimeSafe(&time, &tm);
+  return DaysFromCivil(when->tm_year + 1900L, when->tm_mon + 1, when->tm_mday) * 86400L +
+         when->tm_hour * 3600 + when->tm_min * 60 + when->tm_sec - time;
+}
+
+void BuildLocalTimeTable(LocalTimeTable &table, const time_t from,
+                         const time_t to) {
+  //offset changes are searched for at this granularity; two changes
+  //within it would go unnoticed
+  const time_t step = 6 * 3600;
+  time_t time, next, offset;
+
+  table.starts.clear();
+  table.offsets.clear();
+  table.end = from;
+  if(to <= from)
+    return;
+  offset = UtcOffset(from);
+  table.starts.push_back(from);
+  table.offsets.push_back(offset);
+  for(time = from; time < to; time = next) {
+    next = min(time + step, to);
+    if(UtcOffset(next) == offset)
+      continue;
+    time_t lo = time, hi = next; //offset at lo is 'offset', at hi it is not
+    while(hi - lo > 1) {
+      time_t mid = lo + (hi - lo) / 2;
+      if(UtcOffset(mid) == offset)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    next = hi;
+    offset = UtcOffset(hi);
+    table.starts.push_back(hi);
+    table.offsets.push_back(offset);
+  }
+  table.end = to;
+}
+
+void LocalDayTime(const time_t time, time_t &daytime, int &weekday,
+                  Day &stdtm_day, const LocalTimeTable &table) {
+  if(table.starts.empty() || time < table.starts.front() || time >= table.end) {
+    tm tm, *when;
+
+    when = LocaltimeSafe(&time, &tm);
+    daytime = when->tm_hour * 3600 + when->tm_min * 60 + when->tm_sec;
+    weekday = when->tm_wday;
+    stdtm_day.year = when->tm_year;
+    stdtm_day.month = when->tm_mon;
+    stdtm_day.day = when->tm_mday;
+    return;
+  }
+  size_t i = upper_bound(table.starts.begin(), table.starts.end(), time) -
+             table.starts.begin() - 1;
+  time_t wall = time + table.offsets[i];
+  long days = FloorDiv(wall, 86400), year;
+  unsigned month, day;
+  daytime = wall - (time_t)days * 86400;
+  weekday = (int)((days % 7 + 11) % 7); //1970-01-01 was a Thursday
+  CivilFromDays(days, year, month, day);
+  stdtm_day.year = (int)(year - 1900);
+  stdtm_day.month = (int)month - 1;
+  stdtm_day.day = (int)day;
+}
+
+//end of the span of constant UTC offset that contains "time", or "time"
+//itself if the span is not known
+static time_t LocalOffsetStableUntil(const time_t time,
+                                     const LocalTimeTable &table) {
+  if(table.starts.empty() || time < table.starts.front() || time >= table.end)
+    return time;
+  vector<time_t>::const_iterator next =
+    upper_bound(table.starts.begin(), table.starts.end(), time);
+  return next != table.starts.end() ? *next : table.end;
+}
+
 tm *GmtimeSafe(const time_t *timep, tm *result) {
 #ifndef PSS_THREAD_SAFE_TIME_UNAVAILABLE
 #ifdef WIN32
@@ -154,12 +262,6 @@ void GetStdTmDay(Day &stdtm_day, const time_t time) {
   GetStdTmDay(stdtm_day, when);
 }
 
-void GetEveryYearDay(Day &everyyear_day, const Day &day) {
-  everyyear_day.year = numeric_limits<int>::min();
-  everyyear_day.month = day.month;
-  everyyear_day.day = day.day;
-}
-
 time_t GetTimeOffset(const TimeofDay time) {
   time_t local_origin;
   tm when;
@@ -292,8 +394,43 @@ void GetTmslot247(TintvlVec2d &weekts, DayTs &dayts) {
   weekts.resize(7); //number of days in a week
   tmslot_24_7.push_back(tintvl_24);
   fill(weekts.begin(), weekts.end(), tmslot_24_7);
-  dayts.once.clear();
-  dayts.everyyear.clear();
+  dayts.clear();
+}
+
+//month and day within the range of a std tm day, i.e., no two days share a key
+static bool ValidStdTmDay(const Day &stdtm_day) {
+  return stdtm_day.month >= 0 && stdtm_day.month < 12 &&
+         stdtm_day.day >= 1 && stdtm_day.day <= 31;
+}
+
+//flattens 'days' into 'index'
+static void BuildDayIndex(DayIndex &index, const map<int, vector<Tintvl> > &days) {
+  map<int, vector<Tintvl> >::const_iterator d;
+
+  index = DayIndex();
+  index.keys.reserve(days.size());
+  index.firsts.reserve(days.size() + 1);
+  for(d = days.begin(); d != days.end(); ++d) {
+    index.keys.push_back(d->first);
+    index.firsts.push_back(index.slots.size());
+    index.slots.insert(index.slots.end(), d->second.begin(), d->second.end());
+  }
+  index.firsts.push_back(index.slots.size());
+}
+
+//returns false if 'key' is not in 'index', otherwise [first, last) are its slots
+static bool FindDay(const DayIndex &index, const int key,
+                    vector<Tintvl>::const_iterator &first,
+                    vector<Tintvl>::const_iterator &last) {
+  vector<int>::const_iterator k;
+
+  k = lower_bound(index.keys.begin(), index.keys.end(), key);
+  if(k == index.keys.end() || *k != key)
+    return false;
+  size_t i = k - index.keys.begin();
+  first = index.slots.begin() + index.firsts[i];
+  last = index.slots.begin() + index.firsts[i + 1];
+  return true;
 }
 
 void GetTmslot(TintvlVec2d &weekts, DayTs &dayts, const vector<Schedule> schds) {
@@ -301,7 +438,7 @@ void GetTmslot(TintvlVec2d &weekts, DayTs &dayts, const vector<Schedule> schds)
   vector<SchedTmSlot>::const_iterator i;
   SchedTmSlotVisitor visitor;
   vector<Tintvl> tmslot_default;
-  Day everyyear_day;
+  map<int, vector<Tintvl> > once, everyyear;
 
   schd_tms.resize(schds.size());
   transform(schds.begin(), schds.end(), schd_tms.begin(),
@@ -321,14 +458,21 @@ void GetTmslot(TintvlVec2d &weekts, DayTs &dayts, const vector<Schedule> schds)
       weekts[(*i).weekday] = (*i).tmslots;
       //cerr << (*i).weekday << ": [" << (*i).tmslot.begin().start << ", " << (*i).tmslot.end().end << "]\n";
     } else if((*i).weekday == -1) { //dateschd
-      if(!(*i).everyyear) {
-        dayts.once[(*i).day] = (*i).tmslots;
-      } else {
-        GetEveryYearDay(everyyear_day, (*i).day);
-        dayts.everyyear[everyyear_day] = (*i).tmslots;
-      }
+      if(!ValidStdTmDay((*i).day)) //never the day of a time, as before
+        continue;
+      if(!(*i).everyyear)
+        once[DayKey((*i).day)] = (*i).tmslots;
+      else
+        everyyear[YearDayKey((*i).day)] = (*i).tmslots;
     }
   }
+  dayts.clear();
+  BuildDayIndex(dayts.once, once);
+  BuildDayIndex(dayts.everyyear, everyyear);
+  for(i = schd_tms.begin(); i != schd_tms.end(); ++i) {
+    if((*i).weekday == -1 && ValidStdTmDay((*i).day))
+      dayts.yeardays.set(YearDayKey((*i).day));
+  }
   // for debugging:
   //            for (int d = 0; d < 7; ++d)
   //            {
@@ -372,12 +516,14 @@ struct TintvlGtEq : public binary_function<Tintvl, time_t, bool> {
 };
 
 //assumes tintvls are ordered chronologically (i.e., earliest intvl first)
-//returns false if no such time interval exists in "tintvls"
-bool TintvlSince(Tintvl &tintvl, const time_t time, const vector<Tintvl> &tintvls) {
+//returns false if no such time interval exists in [first, last)
+static bool TintvlSince(Tintvl &tintvl, const time_t time,
+                        vector<Tintvl>::const_iterator first,
+                        vector<Tintvl>::const_iterator last) {
   vector<Tintvl>::const_iterator t;
 
-  t = find_if(tintvls.begin(), tintvls.end(), bind2nd(TintvlGtEq(), time));
-  if(t != tintvls.end()) {
+  t = find_if(first, last, bind2nd(TintvlGtEq(), time));
+  if(t != last) {
     if((*t).start < time)
       tintvl.start = time;
     else
@@ -390,6 +536,10 @@ bool TintvlSince(Tintvl &tintvl, const time_t time, const vector<Tintvl> &tintvl
   }
 }
 
+bool TintvlSince(Tintvl &tintvl, const time_t time, const vector<Tintvl> &tintvls) {
+  return TintvlSince(tintvl, time, tintvls.begin(), tintvls.end());
+}
+
 void TintvlShift(Tintvl &tintvl, const time_t delta) {
   tintvl.start += delta;
   tintvl.end += delta;
@@ -398,26 +548,17 @@ void TintvlShift(Tintvl &tintvl, const time_t delta) {
 //if true, then "tintvl" stores the earliest time interval since "time"
 bool SpecialDay(const Day &stdtm_day, const time_t &time,
                 const time_t &daytime, const DayTs &dayts, Tintvl &tintvl) {
-  Day everyyear_day;
-  DayMap::const_iterator d;
+  vector<Tintvl>::const_iterator first, last;
 
   //GetStdTmDay(stdtm_day, time); supplied by the caller
-  d = dayts.once.find(stdtm_day);
-  if(d == dayts.once.end()) {
-    GetEveryYearDay(everyyear_day, stdtm_day);
-    d = dayts.everyyear.find(everyyear_day);
-    if(d == dayts.everyyear.end())
-      return false;
-    else {
-      if(TintvlSince(tintvl, daytime, (*d).second))
-        TintvlShift(tintvl, time - daytime);
-      return true;
-    }
-  } else {
-    if(TintvlSince(tintvl, daytime, (*d).second))
-      TintvlShift(tintvl, time - daytime);
-    return true;
-  }
+  if(!dayts.yeardays.test(YearDayKey(stdtm_day)))
+    return false;
+  if(!FindDay(dayts.once, DayKey(stdtm_day), first, last) &&
+     !FindDay(dayts.everyyear, YearDayKey(stdtm_day), first, last))
+    return false;
+  if(TintvlSince(tintvl, daytime, first, last))
+    TintvlShift(tintvl, time - daytime);
+  return true;
 }
 
 bool IsLeapYear(int stdtm_year) {
@@ -507,6 +648,52 @@ void EarliestUnitRsrcTintvl(Tintvl &tintvl, time_t &time, time_t &daytime,
   }
 }
 
+CalendarKind GetCalendarKind(const TintvlVec2d &weekts, const DayTs &dayts) {
+  TintvlVec2d::const_iterator w;
+
+  if(!dayts.empty())
+    return kSpecialDays;
+  for(w = weekts.begin(); w != weekts.end(); ++w) {
+    if((*w).size() != 1 || (*w).front().start != 0 ||
+        (*w).front().end != 24 * 3600 - 1)
+      return kWeeklyOnly;
+  }
+  return kAlwaysOpen;
+}
+
+//calendar walks, i.e., EarliestUnitRsrcTintvl() specialized by CalendarKind;
+//'kWeekly' is true if the walk repeats itself every week
+struct SpecialDaysWalk {
+  static const bool kWeekly = false;
+  static void Earliest(Tintvl &tintvl, time_t &time, time_t &daytime,
+                       Day &stdtm_day, const DayTs &dayts, int &weekday,
+                       const TintvlVec2d &weekts) {
+    EarliestUnitRsrcTintvl(tintvl, time, daytime, stdtm_day, dayts, weekday, weekts);
+  }
+};
+
+//no special days to look up
+struct WeeklyOnlyWalk {
+  static const bool kWeekly = true;
+  static void Earliest(Tintvl &tintvl, time_t &time, time_t &daytime,
+                       Day &stdtm_day, const DayTs &, int &weekday,
+                       const TintvlVec2d &weekts) {
+    while(!TintvlSince(tintvl, daytime, weekts[weekday]))
+      NextDay(weekday, stdtm_day, time, daytime);
+    TintvlShift(tintvl, time - daytime);
+  }
+};
+
+//open until the end of the current day
+struct AlwaysOpenWalk {
+  static const bool kWeekly = true;
+  static void Earliest(Tintvl &tintvl, time_t &time, time_t &daytime,
+                       Day &, const DayTs &, int &, const TintvlVec2d &) {
+    tintvl.start = time;
+    tintvl.end = time + 24 * 3600 - 1 - daytime;
+  }
+};
+
 //finds the earliest _consecutive_ time intvl within [tintvl.start, tintvl.end] s.t. intid <= quota
 //returns true if such time intvl exists, and the value of 'tintvl' is updated accordingly
 //otherwise it returns false
@@ -559,30 +746,122 @@ void EarliestMultiRsrcTintvl(Tintvl &tintvl, time_t &time, time_t &daytime,
   }
 }
 
-void EarliestSlot(vector<Tintvl> &tintvls,
-                  const unsigned int jobintid,
-                  const unsigned int seqid,
-                  const bool is_first_batch,
-                  const time_t start,
-                  const time_t setup0,
-                  const time_t setup1,
-                  const int quantity,
-                  const double unitdur,
-                  const TintvlVec2d &weekts,
-                  const DayTs &dayts) {
+//units produced in the week from "start", a slot boundary, with "setup"
+//charged in every slot; the slots that produce go to "tintvls" if not NULL
+template <class CalendarWalk>
+static int WeekProduction(const time_t start, const time_t setup,
+                          const double unitdur, const TintvlVec2d &weekts,
+                          const DayTs &dayts,
+                          const LocalTimeTable &localtime,
+                          StepTintvls *tintvls, const unsigned int jobintid,
+                          const unsigned int seqid) {
+  int weekday, produced, total = 0;
+  time_t est, est_daytime, dur_tintvl;
+  Tintvl tintvl, slot;
+  Day stdtm_day;
+
+  for(est = start; ; est = tintvl.end + 1) {
+    LocalDayTime(est, est_daytime, weekday, stdtm_day, localtime);
+    CalendarWalk::Earliest(tintvl, est, est_daytime, stdtm_day,
+                           dayts, weekday, weekts);
+    if(tintvl.start >= start + 7 * 24 * 3600)
+      return total;
+    dur_tintvl = tintvl.end - tintvl.start + 1;
+    if(dur_tintvl <= setup)
+      continue;
+    produced = static_cast<int>(floor((double)(dur_tintvl - setup) / unitdur));
+    if(produced > 0 && tintvls) {
+      slot.start = tintvl.start;
+      slot.end = tintvl.start + setup +
+                 static_cast<time_t>(ceil(produced * unitdur)) - 1;
+      slot.intid = jobintid;
+      slot.seqid = seqid;
+      tintvls->push_back(slot);
+    }
+    total += produced;
+  }
+}
+
+//jumps the capacity walk from "start", the end of a slot, over whole weeks
+//while "quantity" units are left to produce with "setup" charged in every
+//slot; the weekly pattern repeats as long as there are no special days and
+//the UTC offset stays the same, and so does the production of a week in
+//which the job cannot finish. Only worth it for jobs of a few weeks
+//NOTE: the slots skipped go to "tintvls" if not NULL
+template <class CalendarWalk>
+static void SkipWeeks(int &quantity, time_t &start, const time_t end,
+                      const time_t setup, const double unitdur,
+                      const TintvlVec2d &weekts, const DayTs &dayts,
+                      const LocalTimeTable &localtime, StepTintvls *tintvls,
+                      const unsigned int jobintid,
+                      const unsigned int seqid) {
+  const time_t week = 7 * 24 * 3600;
+  time_t weeks, daytime;
+  int weekday, produced;
+  Day stdtm_day;
+  vector<Tintvl>::const_iterator t;
+
+  if(!CalendarWalk::kWeekly || quantity * unitdur <= 2. * week ||
+     end - start <= 2 * week)
+    return;
+  //the walk into the week after the last one skipped must not see a change
+  weeks = (LocalOffsetStableUntil(start, localtime) - start) / week - 1;
+  if(weeks <= 0)
+    return;
+  //a slot found by a walk across an offset change can end in the middle of
+  //a slot of the new offset; the week from there does not repeat
+  LocalDayTime(start, daytime, weekday, stdtm_day, localtime);
+  for(t = weekts[weekday].begin(); t != weekts[weekday].end(); ++t) {
+    if((*t).start < daytime && daytime <= (*t).end)
+      return;
+  }
+  size_t first = tintvls ? tintvls->size() : 0;
+  produced = WeekProduction<CalendarWalk>(start, setup, unitdur, weekts, dayts,
+                                          localtime, tintvls, jobintid, seqid);
+  if(produced > 0)
+    weeks = min(weeks, static_cast<time_t>((quantity - 1) / produced));
+  else
+    weeks = 0;
+  if(weeks <= 0) {
+    if(tintvls)
+      tintvls->resize(first);
+    return;
+  }
+  if(tintvls) {
+    size_t last = tintvls->size();
+    for(time_t w = 1; w < weeks; ++w) {
+      for(size_t i = first; i < last; ++i) {
+        Tintvl slot = (*tintvls)[i];
+        TintvlShift(slot, w * week);
+        tintvls->push_back(slot);
+      }
+    }
+  }
+  quantity -= static_cast<int>(weeks) * produced;
+  start += weeks * week;
+}
+
+template <class CalendarWalk>
+static void EarliestSlotWith(StepTintvls &tintvls,
+                             const unsigned int jobintid,
+                             const unsigned int seqid,
+                             const bool is_first_batch,
+                             const time_t start,
+                             const time_t setup0,
+                             const time_t setup1,
+                             const int quantity,
+                             const double unitdur,
+                             const TintvlVec2d &weekts,
+                             const DayTs &dayts,
+                             const LocalTimeTable &localtime) {
   int weekday, produced;
   time_t est, est_daytime, dur_tintvl, setup, spdur, nextstart;
   Tintvl tintvl;
   Day stdtm_day;
-  tm tm, *lctime;
 
-  //::localtime_r(&start, &lctime);
-  lctime = LocaltimeSafe(&start, &tm);
   est = start;
-  est_daytime = lctime->tm_hour * 3600 + lctime->tm_min * 60 + lctime->tm_sec;
-  weekday = lctime->tm_wday;
-  GetStdTmDay(stdtm_day, lctime);
-  EarliestUnitRsrcTintvl(tintvl, est, est_daytime, stdtm_day,
+  LocalDayTime(start, est_daytime, weekday, stdtm_day, localtime);
+  CalendarWalk::Earliest(tintvl, est, est_daytime, stdtm_day,
                          dayts, weekday, weekts);
   assert(tintvl.start >= 0);
   dur_tintvl = tintvl.end - tintvl.start + 1;
@@ -612,9 +891,14 @@ void EarliestSlot(vector<Tintvl> &tintvls,
       //conservative assumption: setup time cannot be sub-divided
       setup0next = setup;
     }
-    EarliestSlot(tintvls, jobintid, seqid, is_first_batch, nextstart,
-                 setup0next, setup1, quantity - produced,
-                 unitdur, weekts, dayts);
+    int left = quantity - produced;
+    if(setup0next == setup1)
+      SkipWeeks<CalendarWalk>(left, nextstart, numeric_limits<time_t>::max(),
+                              setup1, unitdur, weekts, dayts, localtime,
+                              &tintvls, jobintid, seqid);
+    EarliestSlotWith<CalendarWalk>(tintvls, jobintid, seqid, is_first_batch,
+                                   nextstart, setup0next, setup1,
+                                   left, unitdur, weekts, dayts, localtime);
   }
 }
 
@@ -622,25 +906,23 @@ void EarliestSlot(vector<Tintvl> &tintvls,
 //NOTE: end is the start time of the next job already scheduled
 //output parameter: actualEnd = the earliest time a future next job can start
 //NOTE: actualEnd is 1 second past the end time of the job being tested
-bool QuantityTest(const int quantity, const double unitdur,
-                  const time_t setup0, const time_t setup1,
-                  const bool is_first_batch, const time_t start,
-                  const time_t end, const TintvlVec2d &weekts,
-                  const DayTs &dayts, time_t &actualEnd) {
+template <class CalendarWalk>
+static bool QuantityTestWith(const int quantity, const double unitdur,
+                             const time_t setup0, const time_t setup1,
+                             const bool is_first_batch, const time_t start,
+                             const time_t end, const TintvlVec2d &weekts,
+                             const DayTs &dayts,
+                             const LocalTimeTable &localtime,
+                             time_t &actualEnd) {
   int weekday, produced;
   time_t est, est_daytime, dur_tintvl, setup, spdur;
   Tintvl tintvl;
   Day stdtm_day;
-  tm tm, *lctime;
 
-  //::localtime_r(&start, &lctime);
-  lctime = LocaltimeSafe(&start, &tm);
   assert(quantity >= 0);
   est = start;
-  est_daytime = lctime->tm_hour * 3600 + lctime->tm_min * 60 + lctime->tm_sec;
-  weekday = lctime->tm_wday;
-  GetStdTmDay(stdtm_day, lctime);
-  EarliestUnitRsrcTintvl(tintvl, est, est_daytime, stdtm_day,
+  LocalDayTime(start, est_daytime, weekday, stdtm_day, localtime);
+  CalendarWalk::Earliest(tintvl, est, est_daytime, stdtm_day,
                          dayts, weekday, weekts);
   assert(tintvl.start >= 0);
   if(tintvl.start >= end) {  //end is the start time of the next job!
@@ -671,9 +953,14 @@ bool QuantityTest(const int quantity, const double unitdur,
       //conservative assumption: setup time cannot be sub-divided
       setup0next = setup;
     }
-    return QuantityTest(quantity - produced, unitdur, setup0next, setup1,
-                        is_first_batch, tintvl.end + 1, end, weekts,
-                        dayts, actualEnd);
+    int left = quantity - produced;
+    time_t nextstart = tintvl.end + 1;
+    if(setup0next == setup1)
+      SkipWeeks<CalendarWalk>(left, nextstart, end, setup1, unitdur,
+                              weekts, dayts, localtime, NULL, 0, 0);
+    return QuantityTestWith<CalendarWalk>(left, unitdur, setup0next, setup1,
+                                          is_first_batch, nextstart, end,
+                                          weekts, dayts, localtime, actualEnd);
   }
 }
 
@@ -688,35 +975,32 @@ time_t DayTimeByRef(time_t time, time_t timeref, time_t daytimeref) {
   }
 }
 
-void EarliestSlotOprltd(vector<Tintvl> &machsteptintvls,
-                        vector<Tintvl> &oprsteptintvls,
-                        const unsigned int jobintid,
-                        const unsigned int seqid,
-                        const bool is_first_batch,
-                        const time_t start,
-                        const time_t setup0,
-                        const time_t setup1,
-                        const int quantity,
-                        const double unitdur,
-                        const TintvlVec2d &machweekts,
-                        const DayTs &machdayts,
-                        const int oprdemand,
-                        TintvlSet &oprtintvls,
-                        const TintvlVec2d &oprweekts,
-                        const DayTs &oprdayts) {
+template <class CalendarWalk>
+static void EarliestSlotOprltdWith(StepTintvls &machsteptintvls,
+                                   StepTintvls &oprsteptintvls,
+                                   const unsigned int jobintid,
+                                   const unsigned int seqid,
+                                   const bool is_first_batch,
+                                   const time_t start,
+                                   const time_t setup0,
+                                   const time_t setup1,
+                                   const int quantity,
+                                   const double unitdur,
+                                   const TintvlVec2d &machweekts,
+                                   const DayTs &machdayts,
+                                   const int oprdemand,
+                                   TintvlSet &oprtintvls,
+                                   const TintvlVec2d &oprweekts,
+                                   const DayTs &oprdayts,
+                                   const LocalTimeTable &localtime) {
   int weekday, produced;
   time_t est, est_daytime, setup, spdur, oprprodur, machend, machdur;
   Tintvl mach_tintvl, opr_tintvl;
   Day stdtm_day;
-  tm tm, *lctime;
 
-  //::localtime_r(&start, &lctime);
-  lctime = LocaltimeSafe(&start, &tm);
   est = start;
-  est_daytime = lctime->tm_hour * 3600 + lctime->tm_min * 60 + lctime->tm_sec;
-  weekday = lctime->tm_wday;
-  GetStdTmDay(stdtm_day, lctime);
-  EarliestUnitRsrcTintvl(mach_tintvl, est, est_daytime, stdtm_day,
+  LocalDayTime(start, est_daytime, weekday, stdtm_day, localtime);
+  CalendarWalk::Earliest(mach_tintvl, est, est_daytime, stdtm_day,
                          machdayts, weekday, machweekts);
   assert(mach_tintvl.start >= 0);
 
@@ -772,10 +1056,13 @@ void EarliestSlotOprltd(vector<Tintvl> &machsteptintvls,
       //conservative assumption: setup time cannot be sub-divided
       setup0next = setup;
     }
-    EarliestSlotOprltd(machsteptintvls, oprsteptintvls, jobintid, seqid,
-                       is_first_batch, machend + 1, setup0next, setup1,
-                       quantity - produced, unitdur, machweekts, machdayts,
-                       oprdemand, oprtintvls, oprweekts, oprdayts);
+    EarliestSlotOprltdWith<CalendarWalk>(machsteptintvls, oprsteptintvls,
+                                         jobintid, seqid, is_first_batch,
+                                         machend + 1, setup0next, setup1,
+                                         quantity - produced, unitdur,
+                                         machweekts, machdayts, oprdemand,
+                                         oprtintvls, oprweekts, oprdayts,
+                                         localtime);
   }
 }
 
@@ -783,28 +1070,27 @@ void EarliestSlotOprltd(vector<Tintvl> &machsteptintvls,
 //NOTE: end is the start time of the next job
 //output parameter: actualEnd = the earliest time a future next job can start
 //NOTE: actualEnd is 1 second past the end time of the job being tested
-bool QuantityTestOprltd(const int quantity, const double unitdur,
-                        const time_t setup0, const time_t setup1,
-                        const bool is_first_batch, const time_t start,
-                        const time_t end, const TintvlVec2d &machweekts,
-                        const DayTs &machdayts, const int oprdemand,
-                        const TintvlSet &oprtintvls,
-                        const TintvlVec2d &oprweekts, const DayTs &oprdayts,
-                        time_t &actualEnd) {
+template <class CalendarWalk>
+static bool QuantityTestOprltdWith(const int quantity, const double unitdur,
+                                   const time_t setup0, const time_t setup1,
+                                   const bool is_first_batch,
+                                   const time_t start, const time_t end,
+                                   const TintvlVec2d &machweekts,
+                                   const DayTs &machdayts, const int oprdemand,
+                                   const TintvlSet &oprtintvls,
+                                   const TintvlVec2d &oprweekts,
+                                   const DayTs &oprdayts,
+                                   const LocalTimeTable &localtime,
+                                   time_t &actualEnd) {
   int weekday, produced;
   time_t est, est_daytime, setup, spdur, oprprodur, machend, machdur;
   Tintvl mach_tintvl, opr_tintvl;
   Day stdtm_day;
-  tm tm, *lctime;
 
-  //::localtime_r(&start, &lctime);
-  lctime = LocaltimeSafe(&start, &tm);
   assert(quantity >= 0);
   est = start;
-  est_daytime = lctime->tm_hour * 3600 + lctime->tm_min * 60 + lctime->tm_sec;
-  weekday = lctime->tm_wday;
-  GetStdTmDay(stdtm_day, lctime);
-  EarliestUnitRsrcTintvl(mach_tintvl, est, est_daytime, stdtm_day,
+  LocalDayTime(start, est_daytime, weekday, stdtm_day, localtime);
+  CalendarWalk::Earliest(mach_tintvl, est, est_daytime, stdtm_day,
                          machdayts, weekday, machweekts);
   assert(mach_tintvl.start >= 0);
   if(mach_tintvl.start >= end) {  //end is the start time of the next job!
@@ -856,10 +1142,150 @@ bool QuantityTestOprltd(const int quantity, const double unitdur,
       //conservative assumption: setup time cannot be sub-divided
       setup0next = setup;
     }
-    return QuantityTestOprltd(quantity - produced, unitdur, setup0next,
-                              setup1, is_first_batch, machend + 1, end,
-                              machweekts, machdayts, oprdemand, oprtintvls,
-                              oprweekts, oprdayts, actualEnd);
+    return QuantityTestOprltdWith<CalendarWalk>(quantity - produced, unitdur,
+                                                setup0next, setup1,
+                                                is_first_batch, machend + 1,
+                                                end, machweekts, machdayts,
+                                                oprdemand, oprtintvls,
+                                                oprweekts, oprdayts,
+                                                localtime, actualEnd);
+  }
+}
+
+//the machine calendar walk is specialized by 'kind'; the rest is the same
+void EarliestSlot(StepTintvls &tintvls,
+                  const unsigned int jobintid,
+                  const unsigned int seqid,
+                  const bool is_first_batch,
+                  const time_t start,
+                  const time_t setup0,
+                  const time_t setup1,
+                  const int quantity,
+                  const double unitdur,
+                  const TintvlVec2d &weekts,
+                  const DayTs &dayts,
+                  const LocalTimeTable &localtime,
+                  const CalendarKind kind) {
+  switch(kind) {
+  case kAlwaysOpen:
+    EarliestSlotWith<AlwaysOpenWalk>(tintvls, jobintid, seqid, is_first_batch,
+                                     start, setup0, setup1, quantity, unitdur,
+                                     weekts, dayts, localtime);
+    break;
+  case kWeeklyOnly:
+    EarliestSlotWith<WeeklyOnlyWalk>(tintvls, jobintid, seqid, is_first_batch,
+                                     start, setup0, setup1, quantity, unitdur,
+                                     weekts, dayts, localtime);
+    break;
+  default:
+    EarliestSlotWith<SpecialDaysWalk>(tintvls, jobintid, seqid, is_first_batch,
+                                      start, setup0, setup1, quantity, unitdur,
+                                      weekts, dayts, localtime);
+  }
+}
+
+bool QuantityTest(const int quantity, const double unitdur,
+                  const time_t setup0, const time_t setup1,
+                  const bool is_first_batch, const time_t start,
+                  const time_t end, const TintvlVec2d &weekts,
+                  const DayTs &dayts, const LocalTimeTable &localtime,
+                  time_t &actualEnd, const CalendarKind kind) {
+  switch(kind) {
+  case kAlwaysOpen:
+    return QuantityTestWith<AlwaysOpenWalk>(quantity, unitdur, setup0, setup1,
+                                            is_first_batch, start, end,
+                                            weekts, dayts, localtime, actualEnd);
+  case kWeeklyOnly:
+    return QuantityTestWith<WeeklyOnlyWalk>(quantity, unitdur, setup0, setup1,
+                                            is_first_batch, start, end,
+                                            weekts, dayts, localtime, actualEnd);
+  default:
+    return QuantityTestWith<SpecialDaysWalk>(quantity, unitdur, setup0, setup1,
+                                             is_first_batch, start, end,
+                                             weekts, dayts, localtime,
+                                             actualEnd);
+  }
+}
+
+void EarliestSlotOprltd(StepTintvls &machsteptintvls,
+                        StepTintvls &oprsteptintvls,
+                        const unsigned int jobintid,
+                        const unsigned int seqid,
+                        const bool is_first_batch,
+                        const time_t start,
+                        const time_t setup0,
+                        const time_t setup1,
+                        const int quantity,
+                        const double unitdur,
+                        const TintvlVec2d &machweekts,
+                        const DayTs &machdayts,
+                        const int oprdemand,
+                        TintvlSet &oprtintvls,
+                        const TintvlVec2d &oprweekts,
+                        const DayTs &oprdayts,
+                        const LocalTimeTable &localtime,
+                        const CalendarKind machkind) {
+  switch(machkind) {
+  case kAlwaysOpen:
+    EarliestSlotOprltdWith<AlwaysOpenWalk>(machsteptintvls, oprsteptintvls,
+                                           jobintid, seqid, is_first_batch,
+                                           start, setup0, setup1, quantity,
+                                           unitdur, machweekts, machdayts,
+                                           oprdemand, oprtintvls, oprweekts,
+                                           oprdayts, localtime);
+    break;
+  case kWeeklyOnly:
+    EarliestSlotOprltdWith<WeeklyOnlyWalk>(machsteptintvls, oprsteptintvls,
+                                           jobintid, seqid, is_first_batch,
+                                           start, setup0, setup1, quantity,
+                                           unitdur, machweekts, machdayts,
+                                           oprdemand, oprtintvls, oprweekts,
+                                           oprdayts, localtime);
+    break;
+  default:
+    EarliestSlotOprltdWith<SpecialDaysWalk>(machsteptintvls, oprsteptintvls,
+                                            jobintid, seqid, is_first_batch,
+                                            start, setup0, setup1, quantity,
+                                            unitdur, machweekts, machdayts,
+                                            oprdemand, oprtintvls, oprweekts,
+                                            oprdayts, localtime);
+  }
+}
+
+bool QuantityTestOprltd(const int quantity, const double unitdur,
+                        const time_t setup0, const time_t setup1,
+                        const bool is_first_batch, const time_t start,
+                        const time_t end, const TintvlVec2d &machweekts,
+                        const DayTs &machdayts, const int oprdemand,
+                        const TintvlSet &oprtintvls,
+                        const TintvlVec2d &oprweekts, const DayTs &oprdayts,
+                        const LocalTimeTable &localtime, time_t &actualEnd,
+                        const CalendarKind machkind) {
+  switch(machkind) {
+  case kAlwaysOpen:
+    return QuantityTestOprltdWith<AlwaysOpenWalk>(quantity, unitdur, setup0,
+                                                  setup1, is_first_batch,
+                                                  start, end, machweekts,
+                                                  machdayts, oprdemand,
+                                                  oprtintvls, oprweekts,
+                                                  oprdayts, localtime,
+                                                  actualEnd);
+  case kWeeklyOnly:
+    return QuantityTestOprltdWith<WeeklyOnlyWalk>(quantity, unitdur, setup0,
+                                                  setup1, is_first_batch,
+                                                  start, end, machweekts,
+                                                  machdayts, oprdemand,
+                                                  oprtintvls, oprweekts,
+                                                  oprdayts, localtime,
+                                                  actualEnd);
+  default:
+    return QuantityTestOprltdWith<SpecialDaysWalk>(quantity, unitdur, setup0,
+                                                   setup1, is_first_batch,
+                                                   start, end, machweekts,
+                                                   machdayts, oprdemand,
+                                                   oprtintvls, oprweekts,
+                                                   oprdayts, localtime,
+                                                   actualEnd);
   }
 }
 
@@ -869,15 +1295,10 @@ bool UninterruptedTimespan(const time_t start, const time_t end,
   time_t startime, daytime;
   Tintvl tintvl;
   Day stdtm_day;
-  tm tm, *lctime;
 
-  //::localtime_r(&start, &lctime);
-  lctime = LocaltimeSafe(&start, &tm);
   assert(start <= end);
   startime = start;
-  daytime = lctime->tm_hour * 3600 + lctime->tm_min * 60 + lctime->tm_sec;
-  weekday = lctime->tm_wday;
-  GetStdTmDay(stdtm_day, lctime);
+  LocalDayTime(start, daytime, weekday, stdtm_day, LocalTimeTable());
   EarliestUnitRsrcTintvl(tintvl, startime, daytime, stdtm_day,
                          dayts, weekday, weekts);
   assert(tintvl.start >= 0);
@@ -894,16 +1315,11 @@ time_t timespan(const time_t start, const time_t end,
   time_t startime, daytime, dur_tintvl;
   Tintvl tintvl;
   Day stdtm_day;
-  tm tm, *lctime;
 
-  //::localtime_r(&start, &lctime);
-  lctime = LocaltimeSafe(&start, &tm);
   if(start == end) return 1;
   assert(start < end);
   startime = start;
-  daytime = lctime->tm_hour * 3600 + lctime->tm_min * 60 + lctime->tm_sec;
-  weekday = lctime->tm_wday;
-  GetStdTmDay(stdtm_day, lctime);
+  LocalDayTime(start, daytime, weekday, stdtm_day, LocalTimeTable());
   EarliestUnitRsrcTintvl(tintvl, startime, daytime, stdtm_day,
                          dayts, weekday, weekts);
   assert(tintvl.start >= 0);
@@ -1006,77 +1422,82 @@ void InsertResourceTintvl(TintvlSet &set, unsigned intid, time_t start, time_t e
   }
 }
 
-void AddTimePointUsage(map<time_t, int> &time2usage, const TintvlSet &tintvls) {
+//a change of resource usage at a point in time
+typedef pair<time_t, int> UsageEvent;
+
+void AddTimePointUsage(vector<UsageEvent> &events, const TintvlSet &tintvls,
+                       const int sign) {
   TintvlSet::const_iterator i;
 
   for(i = tintvls.begin(); i != tintvls.end(); ++i) {
-    time2usage[(*i).start] += (*i).intid;
-    //time2usage[(*i).end] -= (*i).intid;
-    time2usage[(*i).end + 1] -= (*i).intid;
+    events.push_back(UsageEvent((*i).start, sign * (int)(*i).intid));
+    events.push_back(UsageEvent((*i).end + 1, -sign * (int)(*i).intid));
   }
 }
 
-//adding two TintvlSet means dividing into finer-grained intervals
-//s.t. the "intid" of each interval is the same
-//e.g., adding {intid = 1, start = 0, end = 10} and {intid = 2, start = 5, end = 8}
-//      =  {1, 0, 4}, {3, 5, 8}, and {1, 9, 10}
-void TintvlSetAdd(const TintvlSet &set1, const TintvlSet &set2, TintvlSet &result) {
+void AddTimePointUsage(vector<UsageEvent> &events, const StepTintvls &tintvls,
+                       const int sign) {
+  StepTintvls::const_iterator i;
+
+  for(i = tintvls.begin(); i != tintvls.end(); ++i) {
+    events.push_back(UsageEvent((*i).start, sign * (int)(*i).intid));
+    events.push_back(UsageEvent((*i).end + 1, -sign * (int)(*i).intid));
+  }
+}
+
+//sweeps the time-sorted 'events' and inserts one interval per stretch
+//between two consecutive time points at which some usage changes
+//(even if the changes cancel out) into 'result'
+void InsertUsageTintvls(TintvlSet &result, vector<UsageEvent> &events) {
   int intid;
   time_t prev_start;
-  map<time_t, int> time2usage;
-  map<time_t, int>::const_iterator t;
+  vector<UsageEvent>::const_iterator t;
 
+  sort(events.begin(), events.end());
   intid = 0;
   prev_start = -1;
-  AddTimePointUsage(time2usage, set1);
-  AddTimePointUsage(time2usage, set2);
-  result.clear(); //must follow AddTimePointUsage() to allow set1 = result
-  for(t = time2usage.begin(); t != time2usage.end(); ++t) {
+  for(t = events.begin(); t != events.end();) {
+    time_t time = t->first;
+    int usage = 0;
+    for(; t != events.end() && t->first == time; ++t)
+      usage += t->second;
     if(prev_start != -1) {
-      InsertResourceTintvl(result, intid, prev_start, t->first - 1);
-      prev_start = t->first;
-      intid += t->second;
+      InsertResourceTintvl(result, intid, prev_start, time - 1);
+      prev_start = time;
+      intid += usage;
     } else {
-      prev_start = t->first;
-      intid = t->second;
+      prev_start = time;
+      intid = usage;
     }
   }
 }
 
-void AddTimePointUsage(map<time_t, int> &time2usage, const vector<Tintvl> &tintvls) {
-  vector<Tintvl>::const_iterator i;
+//adding two TintvlSet means dividing into finer-grained intervals
+//s.t. the "intid" of each interval is the same
+//e.g., adding {intid = 1, start = 0, end = 10} and {intid = 2, start = 5, end = 8}
+//      =  {1, 0, 4}, {3, 5, 8}, and {1, 9, 10}
+void TintvlSetAdd(const TintvlSet &set1, const TintvlSet &set2, TintvlSet &result) {
+  vector<UsageEvent> events;
 
-  for(i = tintvls.begin(); i != tintvls.end(); ++i) {
-    time2usage[(*i).start] += (*i).intid;
-    time2usage[(*i).end + 1] -= (*i).intid;
-  }
+  events.reserve(2 * (set1.size() + set2.size()));
+  AddTimePointUsage(events, set1, 1);
+  AddTimePointUsage(events, set2, 1);
+  result.clear(); //must follow AddTimePointUsage() to allow set1 = result
+  InsertUsageTintvls(result, events);
 }
 
 //adding two TintvlSet means dividing into finer-grained intervals
 //s.t. the "intid" of each interval is the same
 //e.g., adding {intid = 1, start = 0, end = 10} and {intid = 2, start = 5, end = 8}
 //      =  {1, 0, 4}, {3, 5, 8}, and {1, 9, 10}
-void TintvlSetAdd(const TintvlSet &set1, const vector<Tintvl> &set2, TintvlSet &result) {
-  int intid;
-  time_t prev_start;
-  map<time_t, int> time2usage;
-  map<time_t, int>::const_iterator t;
+void TintvlSetAdd(const TintvlSet &set1, const StepTintvls &set2, TintvlSet &result) {
+  vector<UsageEvent> events;
 
-  intid = 0;
-  prev_start = -1;
-  AddTimePointUsage(time2usage, set1);
-  AddTimePointUsage(time2usage, set2);
+  events.reserve(2 * (set1.size() + set2.size()));
+  AddTimePointUsage(events, set1, 1);
+  AddTimePointUsage(events, set2, 1);
   result.clear(); //must follow AddTimePointUsage() to allow set1 = result
-  for(t = time2usage.begin(); t != time2usage.end(); ++t) {
-    if(prev_start != -1) {
-      InsertResourceTintvl(result, intid, prev_start, t->first - 1);
-      prev_start = t->first;
-      intid += t->second;
-    } else {
-      prev_start = t->first;
-      intid = t->second;
-    }
-  }
+  InsertUsageTintvls(result, events);
 }
 
 //NOTE: set is modified to be set = set - projset
@@ -1121,40 +1542,19 @@ void tintvl_set_project_range(TintvlSet &set, const time_t min_start,
 //      =  {1, 0, 4}, {3, 5, 8}, and {1, 9, 10}
 //ASSUMPTION: set2 is smaller than set1 --> it's more efficient to project set1 onto set2 first
 //Results are stored back to set1
-void TintvlSetAdd(TintvlSet &set1, const vector<Tintvl> &set2) {
-  int intid;
-  time_t min_start, max_end, prev_start;
-  map<time_t, int> time2usage;
-  map<time_t, int>::const_iterator t;
+void TintvlSetAdd(TintvlSet &set1, const StepTintvls &set2) {
+  time_t min_start, max_end;
+  vector<UsageEvent> events;
   TintvlSet set1proj;
 
-  intid = 0;
-  prev_start = -1;
   min_start = set2.begin()->start;
   max_end = set2.rbegin()->end;
   assert(min_start <= max_end);
   tintvl_set_project_range(set1, min_start, max_end, set1proj);
-  AddTimePointUsage(time2usage, set1proj);
-  AddTimePointUsage(time2usage, set2);
-  for(t = time2usage.begin(); t != time2usage.end(); ++t) {
-    if(prev_start != -1) {
-      InsertResourceTintvl(set1, intid, prev_start, t->first - 1);
-      prev_start = t->first;
-      intid += t->second;
-    } else {
-      prev_start = t->first;
-      intid = t->second;
-    }
-  }
-}
-
-void SubtractTimePointUsage(map<time_t, int> &time2usage, const TintvlSet &tintvls) {
-  TintvlSet::const_iterator i;
-
-  for(i = tintvls.begin(); i != tintvls.end(); ++i) {
-    time2usage[(*i).start] -= (*i).intid;
-    time2usage[(*i).end + 1] += (*i).intid;
-  }
+  events.reserve(2 * (set1proj.size() + set2.size()));
+  AddTimePointUsage(events, set1proj, 1);
+  AddTimePointUsage(events, set2, 1);
+  InsertUsageTintvls(set1, events);
 }
 
 //subtract set2 from set1
@@ -1162,62 +1562,27 @@ void SubtractTimePointUsage(map<time_t, int> &time2usage, const TintvlSet &tintv
 //e.g., subtract {intid = 1, start = 0, end = 10} from {1, 0, 4}, {3, 5, 8}, and {1, 9, 10}
 //      = {intid = 2, start = 5, end = 8}
 void TintvlSetSubtract(const TintvlSet &set1, const TintvlSet &set2, TintvlSet &result) {
-  int intid;
-  time_t prev_start;
-  map<time_t, int> time2usage;
-  map<time_t, int>::const_iterator t;
+  vector<UsageEvent> events;
 
-  intid = 0;
-  prev_start = -1;
-  AddTimePointUsage(time2usage, set1);
-  SubtractTimePointUsage(time2usage, set2);
+  events.reserve(2 * (set1.size() + set2.size()));
+  AddTimePointUsage(events, set1, 1);
+  AddTimePointUsage(events, set2, -1);
   result.clear(); //must follow AddTimePointUsage() to allow set1 = result
-  for(t = time2usage.begin(); t != time2usage.end(); ++t) {
-    if(prev_start != -1) {
-      InsertResourceTintvl(result, intid, prev_start, t->first - 1);
-      prev_start = t->first;
-      intid += t->second;
-    } else {
-      prev_start = t->first;
-      intid = t->second;
-    }
-  }
-}
-
-void SubtractTimePointUsage(map<time_t, int> &time2usage, const vector<Tintvl> &tintvls) {
-  vector<Tintvl>::const_iterator i;
-
-  for(i = tintvls.begin(); i != tintvls.end(); ++i) {
-    time2usage[(*i).start] -= (*i).intid;
-    time2usage[(*i).end + 1] += (*i).intid;
-  }
+  InsertUsageTintvls(result, events);
 }
 
 //subtract set2 from set1
 //s.t. the "intid" of each interval is the same
 //e.g., subtract {intid = 1, start = 0, end = 10} from {1, 0, 4}, {3, 5, 8}, and {1, 9, 10}
 //      = {intid = 2, start = 5, end = 8}
-void TintvlSetSubtract(const TintvlSet &set1, const vector<Tintvl> &set2, TintvlSet &result) {
-  int intid;
-  time_t prev_start;
-  map<time_t, int> time2usage;
-  map<time_t, int>::const_iterator t;
+void TintvlSetSubtract(const TintvlSet &set1, const StepTintvls &set2, TintvlSet &result) {
+  vector<UsageEvent> events;
 
-  intid = 0;
-  prev_start = -1;
-  AddTimePointUsage(time2usage, set1);
-  SubtractTimePointUsage(time2usage, set2);
+  events.reserve(2 * (set1.size() + set2.size()));
+  AddTimePointUsage(events, set1, 1);
+  AddTimePointUsage(events, set2, -1);
   result.clear(); //must follow AddTimePointUsage() to allow set1 = result
-  for(t = time2usage.begin(); t != time2usage.end(); ++t) {
-    if(prev_start != -1) {
-      InsertResourceTintvl(result, intid, prev_start, t->first - 1);
-      prev_start = t->first;
-      intid += t->second;
-    } else {
-      prev_start = t->first;
-      intid = t->second;
-    }
-  }
+  InsertUsageTintvls(result, events);
 }
 
 //subtract set2 from set1
@@ -1226,31 +1591,19 @@ void TintvlSetSubtract(const TintvlSet &set1, const vector<Tintvl> &set2, Tintvl
 //      = {intid = 2, start = 5, end = 8}
 //ASSUMPTION: set2 is smaller than set1 --> it's more efficient to project set1 onto set2 first
 //Results are stored back to set1
-void TintvlSetSubtract(TintvlSet &set1, const vector<Tintvl> &set2) {
-  int intid;
-  time_t min_start, max_end, prev_start;
-  map<time_t, int> time2usage;
-  map<time_t, int>::const_iterator t;
+void TintvlSetSubtract(TintvlSet &set1, const StepTintvls &set2) {
+  time_t min_start, max_end;
+  vector<UsageEvent> events;
   TintvlSet set1proj;
 
-  intid = 0;
-  prev_start = -1;
   min_start = set2.begin()->start;
   max_end = set2.rbegin()->end;
   assert(min_start <= max_end);
   tintvl_set_project_range(set1, min_start, max_end, set1proj);
-  AddTimePointUsage(time2usage, set1proj);
-  SubtractTimePointUsage(time2usage, set2);
-  for(t = time2usage.begin(); t != time2usage.end(); ++t) {
-    if(prev_start != -1) {
-      InsertResourceTintvl(set1, intid, prev_start, t->first - 1);
-      prev_start = t->first;
-      intid += t->second;
-    } else {
-      prev_start = t->first;
-      intid = t->second;
-    }
-  }
+  events.reserve(2 * (set1proj.size() + set2.size()));
+  AddTimePointUsage(events, set1proj, 1);
+  AddTimePointUsage(events, set2, -1);
+  InsertUsageTintvls(set1, events);
 }
 
 void TintvlSetSimplify(TintvlSet &tintvls) {
@@ -1287,7 +1640,7 @@ void TintvlSetSimplify(TintvlSet &tintvls) {
   }
 }
 
-void TintvlSetSimplify(vector<Tintvl> &tintvls) {
+void TintvlSetSimplify(StepTintvls &tintvls) {
   size_t i, j, size = tintvls.size();
 
   for(i = 0, j = 1; j < size; ++j) {
@@ -1301,4 +1654,31 @@ void TintvlSetSimplify(vector<Tintvl> &tintvls) {
   tintvls.resize(i + 1);
 }
 
+TintvlUnion::const_iterator &TintvlUnion::const_iterator::operator++(void) {
+  if(FromFirst()) {
+    if(i2_ != set2_->end() && i2_->start == i1_->start)
+      ++i2_;
+    ++i1_;
+  } else
+    ++i2_;
+  return *this;
+}
+
+TintvlUnion::const_iterator &TintvlUnion::const_iterator::operator--(void) {
+  if(i1_ == set1_->begin()) {
+    --i2_;
+  } else if(i2_ == set2_->begin()) {
+    --i1_;
+  } else {
+    TintvlSet::const_iterator prev1 = i1_, prev2 = i2_;
+    --prev1;
+    --prev2;
+    if(!(prev2->start < prev1->start))
+      i2_ = prev2;
+    if(!(prev1->start < prev2->start))
+      i1_ = prev1;
+  }
+  return *this;
+}
+
 }